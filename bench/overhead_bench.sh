@@ -0,0 +1,44 @@
+#!/bin/bash
+#
+# Scheduler overhead 隨 task 數與 RR 時間片的變化
+#
+# 以週期性 timer 執行 RR：2 個 CPU 密集的 fib task 加上 tasks 個交替計算與 sleep 的 burst_sleep task
+# (plugin/example.c)，結束後以 overhead 命令取得 handler 每個 tick 的時間、switch latency 的 p50 / p99
+# 與 scheduler 占 CPU 時間的比例 (overhead 的輸出前面是 shell 的 prompt)。
+#
+# 使用方式：make plugin && bench/overhead_bench.sh ["tasks ..." (預設 "10 100 1000")] ["quantum ms ..." (預設 "10 30 100")]
+
+TASKS=${1:-10 100 1000}
+QUANTA=${2:-10 30 100}
+BIN=./scheduler_simulator
+PLUGIN=./plugin/example.so
+INPUT=$(mktemp)
+trap 'rm -f "$INPUT"' EXIT
+
+if [ ! -x "$BIN" ] || [ ! -f "$PLUGIN" ]; then
+    echo "build first: make && make plugin" >&2
+    exit 1
+fi
+
+printf "%6s %8s %8s %10s %10s %10s %10s %10s\n" tasks quantum ticks "us/tick" "switches" "p50 us" "p99 us" overhead
+for n in $TASKS; do
+    {
+        echo "load $PLUGIN"
+        echo "add F1 fib 1"
+        echo "add F2 fib 1"
+        i=0
+        while [ $i -lt "$n" ]; do
+            echo "add S$i burst_sleep 1"
+            i=$((i + 1))
+        done
+        printf "start\noverhead\nexit\n"
+    } > "$INPUT"
+    for q in $QUANTA; do
+        "$BIN" --rr-quantum "$q" RR < "$INPUT" | awk -v n="$n" -v q="$q" '
+            /ticks +[0-9]/ { for (i = 1; i < NF; i++) if ($i == "ticks") { ticks = $(i + 1); per = substr($(i + 2), 2) } }
+            /^switches / { switches = $2 }
+            /^switch / { p50 = $3; p99 = $9 }
+            /^overhead / { overhead = $2 }
+            END { printf "%6d %8d %8d %10s %10d %10s %10s %10s\n", n, q, ticks, per, switches, p50, p99, overhead }'
+    done
+done
@@ -0,0 +1,43 @@
+#!/bin/bash
+#
+# 一般建置 (執行期選擇 policy) 與只包含一個 policy 的建置 (make POLICY=...) 的排程路徑成本比較
+#
+# 兩者都以 -O2 -flto 編譯，唯一的差別是 -DPOLICY_ONLY。以 virtual 模式執行固定的工作負載：
+# tasks 個 task1，burst 設為 burst 個 tick (所有 task 同時競爭 CPU，每次時間片用完都經過
+# on_tick / enqueue / pick_after / slice / on_dispatch)，輸出丟棄，比較每一輪的 user + sys CPU 時間。
+#
+# 使用方式：bench/policy_bench.sh [policy (預設 RR)] [tasks (預設 200)] [burst (預設 200000)] [rounds (預設 5)]
+
+POLICY=${1:-RR}
+TASKS=${2:-200}
+BURST=${3:-200000}
+ROUNDS=${4:-5}
+DIR=$(mktemp -d)
+trap 'rm -rf "$DIR"' EXIT
+
+LOWER=$(echo "$POLICY" | tr A-Z a-z)
+LIBS="-lpthread -lrt -rdynamic -ldl"
+gcc -O2 -flto=auto -w -o "$DIR/generic" main.c src/*.c $LIBS || exit 1
+gcc -O2 -flto=auto -w -DPOLICY_ONLY=policy_$LOWER -o "$DIR/single" main.c src/*.c $LIBS || exit 1
+
+echo "burst task1 $BURST" > "$DIR/input"
+i=0
+while [ $i -lt "$TASKS" ]; do
+    echo "add T$i task1 1"
+    i=$((i + 1))
+done >> "$DIR/input"
+printf "start\nexit\n" >> "$DIR/input"
+
+# 執行一次，輸出 CPU 時間 (s)
+run() {
+    local TIMEFORMAT="%U %S"
+    { time "$DIR/$1" --virtual "$POLICY" < "$DIR/input" > /dev/null 2>&1; } 2> "$DIR/time"
+    awk '{ printf "%.2f", $1 + $2 }' "$DIR/time"
+}
+
+echo "policy $POLICY, $TASKS tasks x $BURST ticks, $ROUNDS rounds (CPU seconds)"
+r=0
+while [ $r -lt "$ROUNDS" ]; do
+    printf "generic %6s    single %6s\n" "$(run generic)" "$(run single)"
+    r=$((r + 1))
+done
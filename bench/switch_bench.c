@@ -0,0 +1,87 @@
+/**
+ * @file switch_bench.c
+ * @brief Context switch 成本的 benchmark
+ *
+ * 兩個 context (main 與一個 worker) 互相切換 N 次，分別量測兩種 backend 的平均成本：
+ * - ucontext: glibc 的 getcontext/setcontext，每次切換都有 rt_sigprocmask system call
+ * - asm:      context_save/context_load 的手寫 register swap，不進入 kernel
+ *
+ * 使用方式：make bench && ./bench/switch_bench [switches]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "../include/context.h"
+
+#define BENCH_STACK_SIZE (64 * 1024)
+
+static TaskContext main_context;
+static TaskContext worker_context;
+
+static double now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/*
+ * 保存目前的 context 並切換到 to，之後被切換回來時返回 (同 swapcontext)
+ * getcontext 兩次都回傳 0，因此以 stack 上的 flag 區分
+ */
+static void switch_to(TaskContext *from, TaskContext *to)
+{
+    volatile bool switched = false;
+    context_save(from);
+    if (!switched) {
+        switched = true;
+        context_load(to);
+    }
+}
+
+/*
+ * Worker：每次被切換進來就立刻切回 main
+ */
+static void worker()
+{
+    for (;;) {
+        switch_to(&worker_context, &main_context);
+    }
+}
+
+/*
+ * 以指定 backend 來回切換 rounds 次，回傳每次切換的平均 ns (一次來回算兩次切換)
+ */
+static double run(int backend, long rounds)
+{
+    char *stack = malloc(BENCH_STACK_SIZE);
+    context_set_backend(backend);
+    context_make(&worker_context, stack, BENCH_STACK_SIZE, worker, &main_context);
+
+    switch_to(&main_context, &worker_context); /* 先進入 worker 一次，不計入時間 */
+    double start = now_ns();
+    for (long i = 0; i < rounds; i++) {
+        switch_to(&main_context, &worker_context);
+    }
+    double elapsed = now_ns() - start;
+
+    free(stack);
+    return elapsed / (2.0 * rounds);
+}
+
+int main(int argc, char *argv[])
+{
+    long rounds = (argc > 1) ? atol(argv[1]) : 1000000;
+    double uc_ns = run(CONTEXT_UCONTEXT, rounds);
+
+    printf("%10s|%14s\n", "backend", "ns/switch");
+    printf("-------------------------\n");
+    printf("%10s|%14.1f\n", "ucontext", uc_ns);
+#if CONTEXT_HAVE_ASM
+    double asm_ns = run(CONTEXT_ASM, rounds);
+    printf("%10s|%14.1f\n", "asm", asm_ns);
+    printf("speedup: %.1fx\n", uc_ns / asm_ns);
+#endif
+    return 0;
+}
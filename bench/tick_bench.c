@@ -0,0 +1,199 @@
+/**
+ * @file tick_bench.c
+ * @brief 週期性 tick 時間統計成本的 benchmark
+ *
+ * 比較兩種做法下一個 tick 的時間統計成本 (每個 tick 都以 Round Robin 切換一次 task)：
+ * - list: 原本的做法，每個 tick 走訪 READY / WAITING queue，更新每個 Task 結構內的欄位
+ *         (每個 task 一個 cold record，欄位散落在不同的 cache line / page)
+ * - lazy: scheduler 的做法，只在狀態轉換時依 state_tick 把經過的 tick 數補到 hot table
+ *         (task.c 的 account)，每個 tick 的成本與 task 數無關；最後讀取所有 task 的統計
+ *         (ps / summary) 時補上一次，這個成本也分攤到每個 tick 中
+ *
+ * 使用方式：make bench && ./bench/tick_bench [ticks]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "../include/table.h"
+
+/*
+ * 拆分前的 Task 配置：排程欄位與 context、名稱等 cold 資料放在同一個結構
+ */
+typedef struct LegacyTask {
+    ucontext_t context;
+    char *stack;
+    char *task_name;
+    char *function_name;
+    int priority;
+    int state;
+    int tid;
+    int running;
+    int waiting;
+    struct LegacyTask *prev;
+    struct LegacyTask *next;
+    long wake_tick;
+    bool resource[RESOURCE_SIZE];
+    int time_quantum;
+    int turnaround;
+} LegacyTask;
+
+/*
+ * 依 tid 決定 task 的狀態：約 40% READY、50% WAITING、10% TERMINATED，tid 0 為 RUNNING
+ */
+static int bench_state(int i)
+{
+    if (i == 0) {
+        return RUNNING;
+    }
+    int r = (i * 7919) % 10;
+    return (r < 4) ? READY : (r < 9) ? WAITING : TERMINATED;
+}
+
+/*
+ * 與 task.c 的 account 相同的時間統計 (不含時間片與 policy 的 on_tick)：
+ * 把 state_tick ~ now 的 tick 數依目前狀態一次補上
+ */
+static void account(TaskHot *hot, long *state_tick, int slot, long now)
+{
+    long delta = now - state_tick[slot];
+    if (hot->state[slot] == READY) {
+        hot->waiting[slot] += delta;
+    } else if (hot->state[slot] == RUNNING) {
+        hot->running[slot] += delta;
+    }
+    if (hot->state[slot] != TERMINATED) {
+        hot->turnaround[slot] += delta;
+    }
+    state_tick[slot] = now;
+}
+
+static double now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/*
+ * 原本的 scheduler_tick：READY queue、當前 task、WAITING queue
+ */
+static void legacy_tick(LegacyTask *ready, LegacyTask *current, LegacyTask *waiting)
+{
+    for (LegacyTask *ptr = ready; ptr != NULL; ptr = ptr->next) {
+        ptr->waiting++;
+        ptr->turnaround++;
+    }
+    current->running++;
+    current->turnaround++;
+    for (LegacyTask *ptr = waiting; ptr != NULL; ptr = ptr->next) {
+        ptr->turnaround++;
+    }
+}
+
+static void run(int n, int ticks)
+{
+    LegacyTask **tasks = malloc(n * sizeof(LegacyTask *));
+    LegacyTask *ready = NULL, *waiting = NULL, **ready_tail = &ready, **waiting_tail = &waiting;
+    LegacyTask *current = NULL;
+    TaskHot hot = {0};
+    long *state_tick = calloc(n, sizeof(long));
+    int *queue = malloc(n * sizeof(int)); /* lazy 的 READY queue (以 slot 組成的 ring) */
+    int queue_head = 0, queue_count = 0, running_slot = 0;
+    double start;
+    long checksum = 0;
+
+    for (int i = 0; i < n; i++) {
+        tasks[i] = calloc(1, sizeof(LegacyTask));
+        tasks[i]->state = bench_state(i);
+        if (tasks[i]->state == RUNNING) {
+            current = tasks[i];
+        } else if (tasks[i]->state == READY) {
+            *ready_tail = tasks[i];
+            ready_tail = &tasks[i]->next;
+        } else if (tasks[i]->state == WAITING) {
+            *waiting_tail = tasks[i];
+            waiting_tail = &tasks[i]->next;
+        }
+        int slot = hot_alloc(&hot);
+        hot.state[slot] = bench_state(i);
+        if (hot.state[slot] == READY) {
+            queue[(queue_head + queue_count++) % n] = slot;
+        }
+    }
+
+    /* list：每個 tick 更新所有 task，之後當前 task 放回 READY queue 尾端，由 queue 開頭的 task 執行 */
+    start = now_ns();
+    for (int t = 0; t < ticks; t++) {
+        legacy_tick(ready, current, waiting);
+        if (ready != NULL) {
+            current->next = NULL;
+            *ready_tail = current;
+            ready_tail = &current->next;
+            current = ready;
+            ready = ready->next;
+            if (ready == NULL) {
+                ready_tail = &ready;
+            }
+        }
+    }
+    double list_ns = (now_ns() - start) / ticks;
+
+    /* lazy：只有切換的兩個 task 補上時間統計，最後一次補上所有 task */
+    start = now_ns();
+    for (int t = 0; t < ticks; t++) {
+        if (queue_count > 0) {
+            int next = queue[queue_head];
+            queue_head = (queue_head + 1) % n;
+            account(&hot, state_tick, running_slot, t + 1);
+            hot.state[running_slot] = READY;
+            queue[(queue_head + queue_count - 1) % n] = running_slot;
+            account(&hot, state_tick, next, t + 1);
+            hot.state[next] = RUNNING;
+            running_slot = next;
+        }
+    }
+    for (int i = 0; i < n; i++) {
+        account(&hot, state_tick, i, ticks);
+    }
+    double lazy_ns = (now_ns() - start) / ticks;
+
+    /* 確認兩種做法的結果相同，也避免 compiler 把迴圈最佳化掉 */
+    for (int i = 0; i < n; i++) {
+        if (tasks[i]->running != hot.running[i] || tasks[i]->waiting != hot.waiting[i] ||
+            tasks[i]->turnaround != hot.turnaround[i]) {
+            printf("mismatch at task %d\n", i);
+            exit(1);
+        }
+        checksum += hot.turnaround[i];
+    }
+
+    printf("%8d|%14.1f|%14.1f|%10.1fx|%12ld\n", n, list_ns / 1000, lazy_ns / 1000, list_ns / lazy_ns, checksum);
+
+    for (int i = 0; i < n; i++) {
+        free(tasks[i]);
+    }
+    free(tasks);
+    free(state_tick);
+    free(queue);
+    free(hot.state);
+    free(hot.running);
+    free(hot.waiting);
+    free(hot.turnaround);
+    free(hot.time_quantum);
+    free(hot.task);
+    free(hot.free_slots);
+}
+
+int main(int argc, char *argv[])
+{
+    int ticks = (argc > 1) ? atoi(argv[1]) : 200;
+    int sizes[] = {1000, 10000, 100000};
+
+    printf("%8s|%14s|%14s|%11s|%12s\n", "tasks", "list (us/tick)", "lazy (us/tick)", "speedup", "checksum");
+    printf("----------------------------------------------------------------\n");
+    for (int i = 0; i < 3; i++) {
+        run(sizes[i], ticks);
+    }
+    return 0;
+}
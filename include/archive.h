@@ -0,0 +1,64 @@
+/**
+ * @file archive.h
+ * @brief 已結束 task 的 archive 標頭檔
+ *
+ * TERMINATED task 的時間統計不會再改變，scheduler 切換離開後就把它的 TCB、stack 與名稱釋放，
+ * 只在 archive 中保留 ps 需要的欄位。archive 只會在尾端新增：
+ * 每個 task 一筆固定大小的 entry，名稱則依序存放在同一塊字串緩衝區中，
+ * 延遲 histogram 壓縮後 (只保留非 0 的 bucket，見 hist.h) 依序存放在另一個陣列中。
+ */
+
+#ifndef ARCHIVE_H
+#define ARCHIVE_H
+
+#include <stddef.h>
+#include "task.h"
+
+/*
+ * 一個已結束 task 的最終資料
+ */
+typedef struct ArchiveEntry {
+    int tid;                 /* Task ID */
+    int priority;            /* 優先權 */
+    int running;             /* 累計執行時間 */
+    int waiting;             /* 累計等待時間 */
+    int turnaround;          /* Turnaround time */
+    int cpu;                 /* 最後所在的 CPU */
+    int migrations;          /* 在 CPU 之間移動的次數 */
+    long vruntime;           /* CFS 的 virtual runtime (us) */
+    int mlfq_level;          /* 結束時在 MLFQ 中的 level */
+    int response;            /* Response time (沒有執行過為 -1) */
+    int burst_predict;       /* 預測的下一個 CPU burst (ms) */
+    int burst_last;          /* 最後一個 CPU burst 的實際長度 (tick) */
+    int burst_count;         /* CPU burst 數 */
+    long burst_error;        /* 預測誤差 (ms) 的絕對值總和 */
+    int deadline;            /* 相對 deadline (tick，0 表示沒有) */
+    int period;              /* period (tick，0 表示只執行一次) */
+    int jobs;                /* 完成的 job 數 */
+    int misses;              /* 超過 deadline 才完成的 job 數 */
+    long lateness;           /* 最大 lateness (tick) */
+    long jitter;             /* job response time 的最大值減去最小值 (tick) */
+    size_t name;             /* 名稱在 names 中的 offset */
+    size_t latency;          /* 延遲 histogram 在 latency 中的 offset */
+    PerfCounters counters;   /* host 端的 CPU 時間與硬體 counter */
+    unsigned char resources; /* 結束時仍持有的資源 (bit i 為資源 i) */
+} ArchiveEntry;
+
+typedef struct TaskArchive {
+    ArchiveEntry *entries; /* 依加入 archive 的順序排列 */
+    int count;             /* entry 數量 */
+    int capacity;          /* entries 陣列容量 */
+    char *names;           /* 所有名稱 (以 '\0' 分隔) */
+    size_t names_used;     /* names 已使用的 bytes */
+    size_t names_capacity; /* names 的容量 */
+    HistPair *latency;       /* 所有 entry 壓縮後的延遲 histogram (delay、wakeup、burst) */
+    size_t latency_used;     /* latency 已使用的 pair 數 */
+    size_t latency_capacity; /* latency 的容量 */
+} TaskArchive;
+
+void archive_add(TaskArchive *, Task *);                     /* 記錄 task 的最終資料 */
+const char *archive_name(TaskArchive *, ArchiveEntry *);     /* 取得 entry 的 task 名稱 */
+ArchiveEntry *archive_find(TaskArchive *, const char *name); /* 依名稱尋找 entry，找不到回傳 NULL */
+void archive_latency(TaskArchive *, ArchiveEntry *, TaskLatency *); /* 還原 entry 的延遲 histogram */
+
+#endif
@@ -6,7 +6,7 @@
  *
  * 分為兩類：
  * 1. 一般 Shell 命令：help, cd, echo, exit, record, mypid
- * 2. Scheduler 控制命令：add, del, ps, start
+ * 2. Scheduler 控制命令：add, del, ps, start, burst, load, summary, trace, stats, overhead
  */
 
 /* 一般 Shell 內建命令 */
@@ -18,10 +18,16 @@ int record(char **args);     /* 顯示命令歷史記錄 */
 int mypid(char **args);      /* 顯示 process ID 資訊 */
 
 /* Scheduler 控制命令 */
-int add(char **args);   /* 新增 task 到系統，並設為 READY state */
-int del(char **args);   /* 刪除指定 task，並設為 TERMINATED state */
-int ps(char **args);    /* 顯示所有 task 狀態 */
-int start(char **args); /* 開始或恢復 scheduler 執行 */
+int add(char **args);     /* 新增 task 到系統，並設為 READY state */
+int del(char **args);     /* 刪除指定 task，並設為 TERMINATED state */
+int ps(char **args);      /* 顯示所有 task 狀態 */
+int start(char **args);   /* 開始或恢復 scheduler 執行 */
+int burst(char **args);   /* 設定 virtual 模式下函數的 CPU burst 長度 */
+int load(char **args);    /* 載入 task 函數的 plugin (shared object) */
+int summary(char **args); /* 顯示平均 waiting / turnaround / response time */
+int trace(char **args);   /* 開始或停止記錄 scheduler trace */
+int stats(char **args);   /* 顯示延遲的 percentile (p50/p90/p99/max) */
+int overhead(char **args); /* 顯示或清除 scheduler overhead 的量測結果 */
 
 /* 內建命令名稱陣列 */
 extern const char *builtin_str[];
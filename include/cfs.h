@@ -0,0 +1,43 @@
+/**
+ * @file cfs.h
+ * @brief CFS (Completely Fair Scheduler) 的標頭檔
+ *
+ * 每個 CPU 的 READY task 放在以 virtual runtime (vruntime) 排序的 red-black tree 中，
+ * pick-next 取最左邊 (vruntime 最小) 的 task (快取，O(1))，插入與移除為 O(log n)。
+ * task 執行時 vruntime 依權重增加：權重由 add 的 priority 換算成 nice 值後查表
+ * (與 Linux 的 sched_prio_to_weight 相同)，nice 0 的 task 執行 1us 時 vruntime 增加 1。
+ * 每次 dispatch 的時間片為 target latency 依權重分配的比例，但不小於 minimum granularity。
+ */
+
+#ifndef CFS_H
+#define CFS_H
+
+#include "task.h"
+
+#define CFS_NICE_0_WEIGHT 1024    /* nice 0 的權重 */
+#define CFS_NICE_OFFSET 20        /* nice = priority - 20 (再限制在 -20 ~ 19) */
+#define CFS_LATENCY_MS 60         /* target latency：每個 READY task 在這段時間內至少執行一次 */
+#define CFS_MIN_GRANULARITY_MS 10 /* 時間片的下限 (一個 tick) */
+
+/*
+ * 一個 CPU 的 CFS run queue
+ */
+typedef struct CfsQueue {
+    Task *root;        /* red-black tree 的 root */
+    Task *leftmost;    /* vruntime 最小的 task */
+    int count;         /* tree 中的 task 數量 */
+    long load;         /* tree 中 task 的權重總和 */
+    long min_vruntime; /* 單調遞增的最小 vruntime (新加入或喚醒的 task 以此為基準) */
+} CfsQueue;
+
+int cfs_nice(int priority);                      /* priority 對應的 nice 值 (-20 ~ 19) */
+int cfs_weight(int priority);                    /* priority 對應的權重 */
+void cfs_insert(CfsQueue *, Task *);             /* 依 vruntime、tid 插入 task */
+void cfs_remove(CfsQueue *, Task *);             /* 從 tree 移除 task */
+Task *cfs_first(CfsQueue *);                     /* 取得 vruntime 最小的 task */
+void cfs_charge(Task *, long us);                /* 執行 us 微秒，依權重增加 vruntime */
+void cfs_update_min(CfsQueue *, Task *current);  /* 依 current 與 leftmost 推進 min_vruntime */
+int cfs_slice(CfsQueue *, Task *);               /* task 這次 dispatch 的時間片 (ms) */
+void cfs_place(CfsQueue *, Task *, bool waking); /* 新加入 (或喚醒) 的 task 以 min_vruntime 為基準 */
+
+#endif
@@ -46,9 +46,9 @@ struct cmd {
 };
 
 /* 命令歷史記錄陣列，儲存最近執行的命令 */
-char *history[MAX_RECORD_NUM];
+extern char *history[MAX_RECORD_NUM];
 /* 歷史記錄計數器，記錄總共執行過的命令數量 */
-int history_count;
+extern int history_count;
 
 /**
  * @brief 從標準輸入讀取一行命令
@@ -0,0 +1,18 @@
+/**
+ * @file compare.h
+ * @brief all 模式 (同時執行多個排程演算法並比較結果) 的標頭檔
+ *
+ * 從 stdin 讀入整份輸入 (與互動模式相同的 shell 命令)，每個演算法 fork 一個 process，
+ * 固定在不同的 host core 上以相同的輸入同時執行。結束後依序輸出每個演算法的輸出，
+ * 最後以並排的表格比較平均 waiting / turnaround / response time、throughput、context switch 次數
+ * 與 scheduling delay / wakeup latency 的 p99 (tail latency)。
+ */
+
+#ifndef COMPARE_H
+#define COMPARE_H
+
+#include "task.h"
+
+int compare_all(); /* 執行 all 模式，回傳 exit status */
+
+#endif
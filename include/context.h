@@ -0,0 +1,55 @@
+/**
+ * @file context.h
+ * @brief Task context switch backend 的標頭檔
+ *
+ * 提供兩種 backend，介面與 getcontext/setcontext/makecontext 相同：
+ * - asm: 手寫的 register 保存/還原 (x86-64 與 AArch64)，只保存 callee-saved registers，
+ *        不保存 signal mask，因此不需要 rt_sigprocmask system call
+ * - ucontext: glibc 的 ucontext API (其他架構，或以 --ucontext 指定)
+ *
+ * context_save() 與 getcontext 相同會「回傳兩次」：保存時回傳一次，
+ * 之後被 context_load() 切換回來時再回傳一次
+ */
+
+#ifndef CONTEXT_H
+#define CONTEXT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <ucontext.h>
+
+/* Backend 種類 */
+#define CONTEXT_UCONTEXT 0 /* glibc ucontext */
+#define CONTEXT_ASM 1      /* 手寫 register swap */
+
+#if defined(__x86_64__) || defined(__aarch64__)
+#define CONTEXT_HAVE_ASM 1
+#else
+#define CONTEXT_HAVE_ASM 0
+#endif
+
+#define CONTEXT_REGS 22 /* asm backend 保存的 register 數 (AArch64: x19-x30、sp、pc、d8-d15) */
+
+/*
+ * Task context：asm backend 使用 regs，ucontext backend 使用 uc
+ */
+typedef struct TaskContext {
+    void *regs[CONTEXT_REGS]; /* asm backend 的 callee-saved registers、stack pointer 與返回位址 */
+    ucontext_t uc;            /* ucontext backend 的 context */
+} TaskContext;
+
+extern int context_backend; /* 目前使用的 backend */
+
+int context_asm_save(TaskContext *) __attribute__((returns_twice));              /* asm backend 的 context_save */
+void context_load(TaskContext *) __attribute__((noreturn));                      /* 切換到 context (同 setcontext) */
+void context_make(TaskContext *, char *, size_t, void (*)(void), TaskContext *); /* 建立 task 的 context (同 makecontext) */
+void context_set_backend(int backend);                                           /* 設定 backend (建立任何 context 前) */
+const char *context_backend_name();                                              /* 目前 backend 的名稱 */
+
+/*
+ * 保存目前的 context (同 getcontext)
+ * 必須是 macro：ucontext backend 的 getcontext 要在呼叫者自己的 stack frame 中執行
+ */
+#define context_save(ctx) (context_backend == CONTEXT_ASM ? context_asm_save(ctx) : getcontext(&(ctx)->uc))
+
+#endif
@@ -0,0 +1,58 @@
+/**
+ * @file cpu.h
+ * @brief 模擬多 CPU 的標頭檔
+ *
+ * 每個 virtual CPU 有自己的 ready queue 與當前 task；task 記錄所在的 CPU (Task.cpu)，
+ * 加入系統時放到負載最低的 CPU，之後只有 work stealing 與 load balancing 會改變它。
+ * 週期性模式下所有 CPU 共用同一個 host thread：每個 10ms 的 timer 只執行一個 CPU，
+ * 所有有工作的 CPU 都執行過一次才算經過一個 tick (因此每個 CPU 的速度與單 CPU 時相同)。
+ * Virtual 模式下所有 CPU 的 CPU burst 同時推進。
+ * M:N 模式 (worker.h) 下每個 CPU 由自己的 worker thread 執行，this_cpu 為 thread-local。
+ */
+
+#ifndef CPU_H
+#define CPU_H
+
+#include "cfs.h"
+#include "edf.h"
+#include "mlfq.h"
+#include "queue.h"
+#include "share.h"
+#include "sjf.h"
+
+#define CPU_MAX 256         /* --cpus 的上限 */
+#define BALANCE_INTERVAL 10 /* 週期性 load balancing 的間隔 (tick) */
+
+/*
+ * 一個 virtual CPU
+ */
+typedef struct Cpu {
+    Task *current;          /* 在此 CPU 上執行的 task (離開 RUNNING 後仍保留，直到下一個 task 被 dispatch) */
+    ReadyQueue ready_queue; /* READY queue (FCFS/RR，依 tid 排序) */
+    PrioQueue prio_queue;   /* READY queue (PP，依 priority 分 level) */
+    CfsQueue cfs_queue;     /* READY queue (CFS，依 vruntime 排序的 red-black tree) */
+    MlfqQueue mlfq_queue;   /* READY queue (MLFQ，每個 level 一個 FIFO queue) */
+    SjfQueue sjf_queue;     /* READY queue (SJF/SRTF，依預測的剩餘 burst 排序的 min-heap) */
+    EdfQueue edf_queue;     /* READY queue (EDF，依絕對 deadline 排序的 min-heap) */
+    StrideQueue stride_queue;   /* READY queue (Stride，依 pass 排序的 min-heap) */
+    LotteryQueue lottery_queue; /* READY queue (Lottery，ticket 數的 Fenwick tree) */
+    int nr_ready;           /* ready queue 中的 task 數量 */
+    long busy_ticks;        /* 有 task 在執行的 tick 數 */
+    long idle_ticks;        /* idle 的 tick 數 */
+    long switches;          /* context switch 次數 (dispatch 的 task 與上一個執行的 task 不同) */
+    TaskContext context;    /* M:N 模式：執行此 CPU 的 worker 的 scheduler 主迴圈 context */
+} Cpu;
+
+extern Cpu *cpus;    /* 所有 CPU */
+extern int nr_cpus;  /* CPU 數量 */
+extern __thread int this_cpu; /* 目前由 host thread 執行的 CPU (M:N 模式下每個 worker 各自一個) */
+
+void cpu_init(int n); /* 建立 n 個 CPU (在加入任何 task 之前) */
+int cpu_self();       /* 讀取 this_cpu (不會被 inline，task 在另一個 worker 上恢復後仍正確，見 cpu.c) */
+int cpu_load(Cpu *);  /* CPU 的負載：READY task 數加上執行中的 task */
+Cpu *cpu_busiest();   /* 負載最高且有 READY task 的 CPU，沒有時回傳 NULL */
+Cpu *cpu_idlest();    /* 負載最低的 CPU (相同時取編號小的) */
+bool cpu_all_idle();  /* 是否所有 CPU 都沒有工作 */
+void cpu_report();    /* 顯示每個 CPU 的使用率 */
+
+#endif
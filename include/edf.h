@@ -0,0 +1,34 @@
+/**
+ * @file edf.h
+ * @brief EDF (Earliest Deadline First) 的標頭檔
+ *
+ * add 時可以指定相對 deadline 與 period (單位：10ms)：每個 job 在 release 後 deadline 個 tick 內
+ * 必須完成，periodic task 的函數結束 (task_exit) 後在下一個 period 的 release 時重新執行。
+ * READY task 放在以目前 job 的絕對 deadline 排序的 min-heap 中 (沒有 deadline 的 task 排在最後，依 tid)，
+ * 插入與移除為 O(log n)，pick-next 為 O(1)。EDF 會搶佔：deadline 較早的 task 變為 READY 時，
+ * 執行中的 task 在下一個 tick 讓出 CPU。
+ */
+
+#ifndef EDF_H
+#define EDF_H
+
+#include "task.h"
+
+#define EDF_NONE (-1)        /* 沒有 deadline 的 task 的絕對 deadline (排在所有 deadline 之後) */
+#define EDF_SLICE (1 << 30) /* EDF 的時間片：不會用完，只在被搶佔時縮短 */
+
+/*
+ * 一個 CPU 的 EDF run queue (以絕對 deadline、tid 排序的 min-heap)
+ */
+typedef struct EdfQueue {
+    Task **heap;  /* heap 陣列 (task 的位置記錄在 Task.heap_index) */
+    int size;     /* heap 中的 task 數量 */
+    int capacity; /* heap 陣列容量 */
+} EdfQueue;
+
+bool edf_before(Task *a, Task *b);   /* task a 目前 job 的絕對 deadline 是否比 b 早 */
+void edf_insert(EdfQueue *, Task *); /* 依絕對 deadline 插入 task */
+void edf_remove(EdfQueue *, Task *); /* 從 heap 移除 task */
+Task *edf_first(EdfQueue *);         /* 取得絕對 deadline 最早的 task */
+
+#endif
@@ -0,0 +1,56 @@
+/**
+ * @file event.h
+ * @brief Scheduler 事件 ring buffer 的標頭檔
+ *
+ * scheduler (包含 SIGVTALRM handler) 不直接以 printf 輸出訊息，而是把事件寫成固定大小的
+ * record 放進 ring buffer；在 handler 之外 (scheduler 主迴圈、模擬結束或暫停時) 由 event_drain
+ * 依序轉成與原本相同的文字輸出到 stdout，開啟 trace 時同時寫到 trace 檔 (trace.h)。
+ *
+ * 所有事件都在 scheduler critical section 中產生，drain 也只在 critical section 中或
+ * 模擬停止後執行，因此同一時間只有一個 producer 與一個 consumer (single-producer ring)。
+ * producer 可能在 handler 中，因此從不 drain：ring 滿時丟棄事件並計數，由下一次 drain 回報。
+ * handler 直接切換 task 時若 ring 已超過一半 (event_crowded)，改經過 scheduler 主迴圈 drain。
+ */
+
+#ifndef EVENT_H
+#define EVENT_H
+
+#include "task.h"
+
+#define EVENT_RING_SIZE (1 << 14) /* ring buffer 的 record 數 (2 的次方) */
+
+/* 事件類型 (Event.type，同時是 trace record 的類型) */
+#define EV_DISPATCH 0 /* task 開始執行：Task %s is running. */
+#define EV_PREEMPT 1  /* 時間片用完或被搶佔，回到 READY (只記錄在 trace) */
+#define EV_SLEEP 2    /* Task %s goes to sleep. */
+#define EV_WAKE 3     /* sleep 結束或重新檢查資源，回到 READY (只記錄在 trace) */
+#define EV_WAIT 4     /* Task %s is waiting resource. */
+#define EV_GRANT 5    /* Task %s gets resource %d */
+#define EV_RELEASE 6  /* Task %s releases resource %d */
+#define EV_EXIT 7     /* Task %s has terminated. */
+#define EV_JOB 8      /* Task %s finishes job %d. */
+#define EV_IDLE 9     /* CPU idle. */
+#define EV_TYPES 10
+
+/* Event.flags */
+#define EVENT_QUIET 0x1 /* 不輸出文字 (同一個 task 重新 dispatch、其他 CPU 仍在執行時的 idle) */
+
+/*
+ * 一個 scheduler 事件
+ */
+typedef struct Event {
+    long tick;  /* 發生時的 jiffies */
+    long ns;    /* 發生時的 CLOCK_MONOTONIC (ns，只在 trace 開啟時記錄) */
+    Task *task; /* 事件的 task (drain 之前 task 不會被回收)，idle 為 NULL */
+    int arg;    /* resource ID 或 job 編號 */
+    short type; /* EV_* */
+    short cpu;  /* 所在的 CPU */
+    int flags;  /* EVENT_QUIET */
+} Event;
+
+void event_push(int type, Task *task, int arg, int cpu, long tick, int flags); /* 寫入一個事件 */
+void event_drain();                                                            /* 輸出 ring 中所有的事件 */
+bool event_pending();                                                          /* ring 中是否有事件 */
+bool event_crowded();                                                          /* ring 是否已超過一半 */
+
+#endif
@@ -0,0 +1,44 @@
+/**
+ * @file hist.h
+ * @brief 固定大小的 log-linear (HDR 形式) histogram 標頭檔
+ *
+ * 值 (非負整數) 依大小分成多個 magnitude，每個 magnitude 再線性分成 HIST_SUB 個 bucket：
+ * - 小於 2 * HIST_SUB 的值每個值一個 bucket (精確)
+ * - 其他值落在 [2^k, 2^(k+1)) 的 magnitude 中，bucket 寬度為 2^(k - HIST_SUB_BITS)
+ * 因此任何 percentile 的相對誤差不超過 1 / HIST_SUB (12.5%)，記錄一個值是 O(1)
+ * (一次 clz 與一次 increment)，記憶體固定，與記錄的數量無關。
+ * percentile 回傳 bucket 的上界 (不超過記錄過的最大值)。
+ */
+
+#ifndef HIST_H
+#define HIST_H
+
+#define HIST_SUB_BITS 3                                    /* 每個 magnitude 的 bucket 數的 bit 數 */
+#define HIST_SUB (1 << HIST_SUB_BITS)                      /* 每個 magnitude 的 bucket 數 (8) */
+#define HIST_BUCKETS ((31 - HIST_SUB_BITS + 1) * HIST_SUB) /* 涵蓋 0 ~ 2^31 - 1 (232 個 bucket) */
+
+/*
+ * Histogram
+ */
+typedef struct Histogram {
+    long count;                         /* 記錄的值的數量 */
+    long max;                           /* 記錄過的最大值 */
+    unsigned int counts[HIST_BUCKETS];  /* 每個 bucket 的數量 */
+} Histogram;
+
+/*
+ * 壓縮後的 histogram (archive 使用)：一個 header (bucket 為 pair 數，count 為 max) 之後接著
+ * 非 0 的 bucket
+ */
+typedef struct HistPair {
+    unsigned int bucket;
+    unsigned int count;
+} HistPair;
+
+void hist_record(Histogram *, long value);                /* 記錄一個值 (負值視為 0) */
+void hist_merge(Histogram *dst, const Histogram *src);    /* 把 src 加到 dst */
+long hist_percentile(const Histogram *, double percent);  /* 第 percent 百分位數 (沒有記錄時為 0) */
+int hist_pack(const Histogram *, HistPair *out);          /* 壓縮 (out 至少 1 + HIST_BUCKETS 個)，回傳 pair 數 */
+int hist_unpack(Histogram *, const HistPair *in);         /* 還原，回傳讀取的 pair 數 */
+
+#endif
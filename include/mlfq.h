@@ -0,0 +1,38 @@
+/**
+ * @file mlfq.h
+ * @brief MLFQ (Multi-Level Feedback Queue) 的標頭檔
+ *
+ * READY task 依所在的 level 放在 FIFO queue 中，pick-next 取最高 (編號最小) 的非空 level 的第一個 task。
+ * 每個 level 有自己的時間片：用完整個時間片的 task 降一個 level，
+ * 在用完之前因 task_sleep / 等待資源而離開 CPU 的 task 保持原本的 level；
+ * 每隔 boost 週期所有 task 回到最高的 level，避免 CPU 密集的 task 在低 level 中 starvation。
+ */
+
+#ifndef MLFQ_H
+#define MLFQ_H
+
+#include "queue.h"
+
+#define MLFQ_LEVEL_MAX 8 /* level 數的上限 */
+
+/*
+ * 一個 CPU 的 MLFQ run queue
+ */
+typedef struct MlfqQueue {
+    TaskList level[MLFQ_LEVEL_MAX]; /* 每個 level 一個 FIFO queue (level 0 優先權最高) */
+    unsigned bitmap;                /* 非空 level 的 bitmap */
+} MlfqQueue;
+
+extern int mlfq_levels;                   /* level 數 */
+extern int mlfq_quantum[MLFQ_LEVEL_MAX];  /* 每個 level 的時間片 (ms，10 的倍數) */
+extern int mlfq_boost_ms;                 /* priority boost 的週期 (ms，10 的倍數) */
+
+bool mlfq_set_quantum(const char *list); /* 以 "10,20,40" 形式設定 level 數與各 level 的時間片 */
+bool mlfq_set_boost(int ms);             /* 設定 priority boost 的週期 */
+void mlfq_insert(MlfqQueue *, Task *);   /* 放到 task 所在 level 的尾端 */
+void mlfq_remove(MlfqQueue *, Task *);   /* 從 queue 移除 task */
+Task *mlfq_first(MlfqQueue *);           /* 取得最高 level 的第一個 task */
+void mlfq_demote(Task *);                /* 用完時間片：降一個 level (已在最低 level 時不變) */
+void mlfq_boost(MlfqQueue *);            /* 把 queue 中所有 task 依序移到 level 0 的尾端 */
+
+#endif
@@ -0,0 +1,38 @@
+/**
+ * @file overhead.h
+ * @brief Scheduler overhead 量測的標頭檔
+ *
+ * 以 CLOCK_MONOTONIC_RAW (vDSO，不受 NTP 調整影響) 量測：
+ * - handler：SIGVTALRM handler 從進入到離開 critical section 的時間 (每次 handler 一個樣本)
+ * - loop：scheduler 主迴圈每次迭代 (取得 lock 到 sched_unlock) 的時間，包含 event drain
+ * - switch latency：task 離開 CPU (時間片用完的 handler 進入時，或 sleep / 等待資源 / 結束的呼叫開始時)
+ *   到下一個 task 即將被載入 (context_load 之前) 的時間；context_load 本身的成本見 bench/switch_bench
+ * scheduler overhead 為 handler 與 loop 的時間占模擬期間 process CPU 時間 (CLOCK_PROCESS_CPUTIME_ID) 的比例。
+ * 所有記錄都在 scheduler critical section 中進行 (M:N 模式下 worker 之間不需要額外同步)。
+ * virtual 模式沒有真實的 timer 與 switch，只記錄 CPU 時間。
+ */
+
+#ifndef OVERHEAD_H
+#define OVERHEAD_H
+
+#include <time.h>
+
+/*
+ * 目前的時間 (ns)
+ */
+static inline long overhead_now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+void overhead_handler(long ns);  /* 記錄一次 handler 的時間 */
+void overhead_schedule(long ns); /* 記錄一次主迴圈迭代的時間 */
+void overhead_switch(long ns);   /* 記錄一次 switch latency */
+void overhead_run_begin();       /* 模擬開始 (或恢復)：開始計算 CPU 時間 */
+void overhead_run_end();         /* 模擬暫停或結束 */
+void overhead_print();           /* 顯示量測結果 */
+void overhead_reset();           /* 清除量測結果 */
+
+#endif
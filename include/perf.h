@@ -0,0 +1,37 @@
+/**
+ * @file perf.h
+ * @brief Host 端硬體 counter (perf_event_open) 的標頭檔
+ *
+ * 每個 host thread 以 perf_event_open 開啟一個 counter group：cycles、instructions、
+ * LLC miss 與 dTLB miss (只計算 user mode)。每次 switch 以一次 read (PERF_FORMAT_GROUP)
+ * 讀取整個 group，把上一次讀取之後的差值計入離開 CPU 的 task。
+ * perf event 無法使用時 (container 或 VM 中沒有 PMU、perf_event_paranoid 限制)，
+ * 只以 CLOCK_THREAD_CPUTIME_ID 記錄每個 task 的 host CPU 時間；個別不支援的 counter 為 0。
+ */
+
+#ifndef PERF_H
+#define PERF_H
+
+#include <stdbool.h>
+
+/* 硬體 counter */
+#define PERF_CYCLES 0       /* CPU cycles */
+#define PERF_INSTRUCTIONS 1 /* 執行的 instruction 數 */
+#define PERF_LLC_MISSES 2   /* last-level cache 的 read miss */
+#define PERF_DTLB_MISSES 3  /* data TLB 的 read miss */
+#define PERF_EVENTS 4
+
+/*
+ * 累計的 counter 值
+ */
+typedef struct PerfCounters {
+    long ns;                 /* host thread 的 CPU 時間 (CLOCK_THREAD_CPUTIME_ID，一定可用) */
+    long count[PERF_EVENTS]; /* 硬體 counter (無法開啟的為 0，見 perf_supported) */
+} PerfCounters;
+
+bool perf_open();                 /* 在目前的 host thread 開啟 counter，回傳是否有任何硬體 counter */
+void perf_close();                /* 關閉目前 host thread 的 counter */
+void perf_charge(PerfCounters *); /* 讀取 counter，上一次讀取之後的差值加到參數 (NULL 表示捨棄) */
+bool perf_supported(int event);   /* 是否曾在任何 host thread 上開啟該硬體 counter */
+
+#endif
@@ -0,0 +1,66 @@
+/**
+ * @file policy.h
+ * @brief 排程演算法 (policy) 介面的標頭檔
+ *
+ * 每個排程演算法是一個 Policy：ready queue 的操作 (enqueue / dequeue / pick_next) 與
+ * scheduler 在各個時間點呼叫的 hook (dispatch、tick、block、wake、migrate)。
+ * scheduler (task.c) 只透過目前的 policy 呼叫這些函數，不再依演算法分支；
+ * 沒有動作的 hook 指向空函數 (不使用 NULL)，呼叫端不需要檢查。
+ *
+ * 以 make POLICY=RR (等) 建置時只包含一個 policy：task.c 中的 policy 為編譯期常數，
+ * 配合 -flto 讓 flags 在編譯期決定、hook 的間接呼叫被改為直接呼叫並 inline，
+ * tick 路徑上沒有執行期的演算法分支。
+ */
+
+#ifndef POLICY_H
+#define POLICY_H
+
+#include "cpu.h"
+
+/* Policy.flags */
+#define POLICY_SLICED 0x1   /* 使用時間片 (dispatch 時以 slice 設定，用完時切換) */
+#define POLICY_PREEMPT 0x2  /* task 變為 READY 時可以搶佔執行中的 task (見 preempts) */
+#define POLICY_CIRCULAR 0x4 /* 下一個 task 從上一個 task 之後開始找 (Round Robin) */
+
+/*
+ * 一個排程演算法
+ */
+typedef struct Policy {
+    const char *name; /* 命令列使用的名稱 */
+    int id;           /* 演算法編號 (task.h 的 FCFS/RR/...，ps 與 summary 使用) */
+    int flags;        /* POLICY_SLICED / POLICY_PREEMPT / POLICY_CIRCULAR */
+    void (*enqueue)(Cpu *, Task *);           /* 放入 ready queue (task 仍為放入前的狀態) */
+    void (*dequeue)(Cpu *, Task *);           /* 從 ready queue 移除 */
+    Task *(*pick_next)(Cpu *);                /* 下一個要執行的 task (仍在 queue 中)，沒有時回傳 NULL */
+    Task *(*pick_after)(Cpu *, Task *);       /* 時間片用完或 task 結束後下一個要執行的 task */
+    int (*slice)(Cpu *, Task *);              /* dispatch 時的時間片 (ms，只在 POLICY_SLICED 時呼叫) */
+    void (*on_dispatch)(Cpu *, Task *);       /* task 開始執行 (已從 queue 移除) */
+    void (*on_tick)(Cpu *, Task *, long);     /* 執行中的 task 經過了 ticks 個 tick */
+    void (*on_block)(Task *, int);            /* task 離開 CPU 進入 WAITING 或結束，參數為結束的 CPU burst (tick) */
+    void (*on_wake)(Cpu *, Task *, bool);     /* task 加入 (false) 或被喚醒 (true)，放入 queue 之前 */
+    bool (*preempts)(Task *, Task *);         /* task 是否應該搶佔 current (只在 POLICY_PREEMPT 時呼叫) */
+    void (*on_migrate)(Task *, Cpu *, Cpu *); /* task 從一個 CPU 移到另一個 CPU */
+    void (*on_clock)(long);                   /* jiffies 前進之後 (可能一次前進多個 tick) */
+} Policy;
+
+#define RR_QUANTUM_MS 30 /* 預設的 RR 時間片 (ms) */
+
+extern int rr_quantum_ms; /* RR 的時間片 (ms) */
+bool rr_set_quantum(int ms); /* 設定 RR 的時間片 (ms，10 的正整數倍) */
+
+extern const Policy policy_fcfs;
+extern const Policy policy_rr;
+extern const Policy policy_pp;
+extern const Policy policy_cfs;
+extern const Policy policy_mlfq;
+extern const Policy policy_sjf;
+extern const Policy policy_srtf;
+extern const Policy policy_edf;
+extern const Policy policy_stride;
+extern const Policy policy_lottery;
+
+const Policy *policy_find(const char *name); /* 依名稱取得 policy，找不到 (或未包含在建置中) 時回傳 NULL */
+void policy_names(char *buf, int size);      /* 以 "FCFS / RR / ..." 列出建置中的 policy 名稱 */
+void set_policy(const Policy *);             /* 設定排程演算法 (task.c) */
+
+#endif
@@ -0,0 +1,84 @@
+/**
+ * @file queue.h
+ * @brief Task queue 資料結構的標頭檔
+ *
+ * 提供 scheduler 使用的各種 per-state queue：
+ * - TaskList: 具有 head/tail 指標的雙向 linked list，
+ *   用於 WAITING queue，enqueue/dequeue 皆為 O(1)
+ * - ReadyQueue: 依 tid 排序的 TaskList，搭配兩層 bitmap index，
+ *   讓 pick-next、RR 的 next-after 與插入都不需要走訪整個 queue
+ * - PrioQueue: PP 使用的多層 priority queue (類似 Linux O(1) scheduler)，
+ *   每個 priority 一個 ReadyQueue，加上記錄非空 level 的 bitmap
+ *
+ * 每個 task 同一時間只會在一個 queue 中 (RUNNING 的 task 不在任何 queue 中)，
+ * 因此共用 Task 結構中的 prev/next 指標
+ */
+
+#ifndef QUEUE_H
+#define QUEUE_H
+
+#include "task.h"
+
+/*
+ * 雙向 linked list，記錄 head/tail 與元素數量
+ */
+typedef struct TaskList {
+    Task *head; /* 第一個 task */
+    Task *tail; /* 最後一個 task */
+    int count;  /* task 數量 */
+} TaskList;
+
+/*
+ * Ready queue：依 tid 由小到大排序 (即 task 加入系統的順序)
+ *
+ * map 以 tid 為 index，bit 為 1 表示該 task 在 queue 中；
+ * summary 的每個 bit 代表 map 中對應的 word 是否非 0。
+ * 透過 summary 可以快速找到前一個/下一個在 queue 中的 tid，
+ * 讓從 WAITING 回到 READY 的 task 能直接插入正確位置。
+ */
+typedef struct ReadyQueue {
+    TaskList list;          /* 依 tid 排序的 task list */
+    unsigned long *map;     /* 第一層 bitmap：每個 tid 一個 bit */
+    unsigned long *summary; /* 第二層 bitmap：每個 map word 一個 bit */
+    int words;              /* map 的 word 數量 */
+} ReadyQueue;
+
+/*
+ * PP 使用的多層 priority queue
+ *
+ * priority 0 ~ PRIO_LEVELS-2 各自對應一個 level (ReadyQueue，同 priority 依 tid 排序)，
+ * bitmap 記錄哪些 level 非空，pick-next 只需 find-first-set。
+ * priority >= PRIO_LEVELS-1 的 task 放在 overflow min-heap (以 priority、tid 排序)，
+ * 對應 bitmap 的最後一個 bit，因此 add 接受的整個 int 範圍都能正確排序。
+ */
+#define PRIO_LEVELS 128                                        /* level 數 (含 overflow) */
+#define PRIO_WORDS (PRIO_LEVELS / (8 * sizeof(unsigned long))) /* level bitmap 的 word 數 */
+
+typedef struct PrioQueue {
+    ReadyQueue level[PRIO_LEVELS - 1]; /* 一般 priority 的 level */
+    unsigned long bitmap[PRIO_WORDS];  /* 非空 level 的 bitmap */
+    Task **heap;                       /* overflow level 的 min-heap */
+    int heap_size;                     /* heap 中的 task 數量 */
+    int heap_capacity;                 /* heap 陣列容量 */
+} PrioQueue;
+
+/* TaskList 操作 */
+void list_push_back(TaskList *, Task *);             /* 加到 list 尾端 */
+void list_push_front(TaskList *, Task *);            /* 加到 list 開頭 */
+void list_insert_after(TaskList *, Task *, Task *);  /* 插入到指定 task 之後 */
+void list_insert_before(TaskList *, Task *, Task *); /* 插入到指定 task 之前 */
+void list_remove(TaskList *, Task *);                /* 從 list 中移除 task */
+
+/* ReadyQueue 操作 */
+void rq_insert(ReadyQueue *, Task *);       /* 依 tid 順序插入 task */
+void rq_remove(ReadyQueue *, Task *);       /* 從 ready queue 移除 task */
+Task *rq_first(ReadyQueue *);               /* 取得 tid 最小的 task */
+Task *rq_next_after(ReadyQueue *, int tid); /* 取得 tid 之後的下一個 task (循環) */
+
+/* PrioQueue 操作 */
+void pq_insert(PrioQueue *, Task *);                 /* 依 priority、tid 插入 task */
+void pq_remove(PrioQueue *, Task *);                 /* 從 priority queue 移除 task */
+Task *pq_first(PrioQueue *);                         /* 取得優先權最高的 task */
+void pq_for_each(PrioQueue *, void (*func)(Task *)); /* 對每個 task 呼叫 func */
+
+#endif
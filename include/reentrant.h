@@ -0,0 +1,26 @@
+/**
+ * @file reentrant.h
+ * @brief Task 可以安全使用的 libc 函數替代版本
+ *
+ * task 可能在任何位置被 SIGVTALRM 切換走。glibc 的 rand() 以 lock 保護內部狀態，
+ * 若 task 在持有 lock 時被切換，下一個呼叫 rand() 的 task 會在同一個 thread 上等待
+ * 永遠不會被釋放的 lock (deadlock)。task_rand() 是不使用 lock 的版本，
+ * 產生的數列與 glibc 的 rand() 相同。
+ *
+ * 不取代 libc 的符號 (scheduler 本身與其他 library 仍使用 libc 的 rand)：
+ * task 程式碼經由 task.h include 這個標頭，其中的 rand() / srand() 以巨集改為呼叫
+ * task_rand() / task_srand()。巨集定義之前先 include <stdlib.h>，libc 的宣告不受影響。
+ */
+
+#ifndef REENTRANT_H
+#define REENTRANT_H
+
+#include <stdlib.h>
+
+int task_rand(void);            /* 同 glibc rand()，不使用 lock */
+void task_srand(unsigned seed); /* 同 glibc srand() */
+
+#define rand() task_rand()
+#define srand(seed) task_srand(seed)
+
+#endif
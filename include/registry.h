@@ -0,0 +1,41 @@
+/**
+ * @file registry.h
+ * @brief Task 函數 registry 的標頭檔
+ *
+ * 以 hash table 保存函數名稱到 task 進入點的對照，task_create 依 add 指定的名稱查詢。
+ * 啟動時登錄 function.c 的內建函數；load 命令以 dlopen 載入 shared object，
+ * 登錄它匯出的 task_functions 陣列中的函數，不需要修改或重新編譯 scheduler。
+ *
+ * Plugin 的寫法：
+ *
+ *     #include "include/registry.h"
+ *     #include "include/task.h"
+ *
+ *     static void spin() { ...; task_exit(); while (1); }
+ *
+ *     const TaskFunction task_functions[] = {{"spin", spin}, {NULL, NULL}};
+ */
+
+#ifndef REGISTRY_H
+#define REGISTRY_H
+
+#include <stdbool.h>
+
+#define REGISTRY_SYMBOL "task_functions" /* plugin 匯出的函數表名稱 */
+
+typedef void (*TaskFunc)(void); /* task 的進入點 */
+
+/*
+ * 函數表的一個項目 (plugin 的函數表以 {NULL, NULL} 結束)
+ */
+typedef struct TaskFunction {
+    const char *name; /* add 時使用的函數名稱 */
+    TaskFunc func;    /* 進入點 (結束時必須呼叫 task_exit) */
+} TaskFunction;
+
+void registry_init();                               /* 登錄 function.c 的內建函數 */
+bool registry_add(const char *name, TaskFunc func); /* 登錄函數，名稱已存在時回傳 false */
+TaskFunc registry_lookup(const char *name);         /* 依名稱取得進入點，找不到回傳 NULL */
+int registry_load(const char *path);                /* 載入 plugin，回傳登錄的函數數量，失敗回傳 -1 */
+
+#endif
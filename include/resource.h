@@ -30,7 +30,7 @@
  * - 檢查所有指定的資源是否都可用
  * - 如果全部可用：分配所有資源給當前 task
  * - 如果任一資源被佔用：task 進入 WAITING State，等待資源釋放
- * - 使用 getcontext/setcontext 機制進行 context switching
+ * - 使用 context_save/context_load 機制進行 context switching
  *
  * 重要特性：
  * - 原子性操作：要麼全部分配成功，要麼全部失敗
@@ -0,0 +1,59 @@
+/**
+ * @file share.h
+ * @brief Proportional-share (Stride / Lottery) scheduling 的標頭檔
+ *
+ * add 的 priority 欄位作為 ticket 數 (0 視為 1 張)，task 長期得到的 CPU 時間與 ticket 數成正比：
+ * - Stride: task 的 stride 為 STRIDE1 / tickets，每執行一個 tick pass 增加 stride，
+ *   每次選擇 pass 最小的 task。READY task 放在以 pass、tid 排序的 min-heap，插入與移除為 O(log n)
+ * - Lottery: 每次選擇時從 READY task 的所有 ticket 中抽一張，持有者執行。ticket 數放在
+ *   Fenwick tree (binary indexed tree) 中，抽籤是 O(log n) 的 prefix sum 搜尋，不需走訪 queue
+ * 兩者的時間片都是一個 tick (SHARE_QUANTUM)。
+ */
+
+#ifndef SHARE_H
+#define SHARE_H
+
+#include "task.h"
+
+#define SHARE_QUANTUM 10    /* Stride / Lottery 的時間片 (ms) */
+#define STRIDE1 (1L << 30)  /* 1 張 ticket 的 stride (ticket 數上限為 STRIDE1) */
+#define LOTTERY_SEED 1      /* 抽籤使用的亂數種子 (固定，讓結果可以重現) */
+
+/*
+ * 一個 CPU 的 Stride run queue (以 pass、tid 排序的 min-heap)
+ */
+typedef struct StrideQueue {
+    Task **heap;  /* heap 陣列 (task 的位置記錄在 Task.heap_index) */
+    int size;     /* heap 中的 task 數量 */
+    int capacity; /* heap 陣列容量 */
+    long pass;    /* global pass：最近被 dispatch 的 task 的 pass，新加入或被喚醒的 task 從這裡開始 */
+} StrideQueue;
+
+/*
+ * 一個 CPU 的 Lottery run queue
+ *
+ * 每個 READY task 佔一個 slot (記錄在 Task.heap_index)，tree 是以 slot 為 index 的 ticket 數
+ * Fenwick tree；移除的 slot 放回 free list 重複使用
+ */
+typedef struct LotteryQueue {
+    long *tree;      /* Fenwick tree (1-based)：tree[i] 為 slot (i - lowbit(i), i] 的 ticket 總和 */
+    Task **task;     /* slot 中的 task (空 slot 為 NULL) */
+    int *free_slots; /* 可重複使用的 slot */
+    int free_count;  /* free_slots 中的 slot 數量 */
+    int used;        /* 使用過的 slot 數量 (含 free slot) */
+    int capacity;    /* slot 數量 (2 的次方) */
+    long total;      /* queue 中的 ticket 總數 */
+} LotteryQueue;
+
+int share_tickets(Task *);                          /* task 的 ticket 數 (priority，至少 1 張) */
+void stride_charge(Task *, long ticks);             /* task 執行了 ticks 個 tick：pass 增加 stride * ticks */
+void stride_place(StrideQueue *, Task *);           /* 加入或被喚醒的 task 的 pass 不小於 global pass */
+void stride_update_pass(StrideQueue *, Task *);     /* task 被 dispatch：推進 global pass */
+void stride_insert(StrideQueue *, Task *);          /* 依 pass 插入 task */
+void stride_remove(StrideQueue *, Task *);          /* 從 heap 移除 task */
+Task *stride_first(StrideQueue *);                  /* 取得 pass 最小的 task */
+void lottery_insert(LotteryQueue *, Task *);        /* 加入 task 的 ticket */
+void lottery_remove(LotteryQueue *, Task *);        /* 移除 task 的 ticket */
+Task *lottery_draw(LotteryQueue *);                 /* 抽出下一個要執行的 task */
+
+#endif
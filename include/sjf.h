@@ -0,0 +1,40 @@
+/**
+ * @file sjf.h
+ * @brief SJF / SRTF (Shortest Job First / Shortest Remaining Time First) 的標頭檔
+ *
+ * 下一個 CPU burst 的長度以過去 burst 的指數平均預測：
+ *     predict = alpha * 上一個 burst 的實際長度 + (1 - alpha) * predict
+ * CPU burst 為 task 從開始執行到 task_sleep / 等待資源 / 結束之間累計的 running
+ * (SRTF 中被搶佔不會結束 burst)。剩餘的 burst 為預測值減去這個 burst 已執行的時間 (不小於 0)。
+ * READY task 放在以剩餘 burst 排序的 min-heap 中，插入與移除為 O(log n)，pick-next 為 O(1)。
+ */
+
+#ifndef SJF_H
+#define SJF_H
+
+#include "task.h"
+
+#define SJF_ALPHA 0.5      /* 預設的 alpha */
+#define SJF_INITIAL_MS 100 /* 預設的初始預測值 (ms) */
+
+/*
+ * 一個 CPU 的 SJF / SRTF run queue (以剩餘 burst、tid 排序的 min-heap)
+ */
+typedef struct SjfQueue {
+    Task **heap;  /* heap 陣列 (task 的位置記錄在 Task.heap_index) */
+    int size;     /* heap 中的 task 數量 */
+    int capacity; /* heap 陣列容量 */
+} SjfQueue;
+
+extern double sjf_alpha;   /* 指數平均的 alpha (0 ~ 1) */
+extern int sjf_initial_ms; /* 第一個 burst 的預測值 (ms) */
+
+bool sjf_set_alpha(double alpha);    /* 設定 alpha (必須在 0 ~ 1 之間) */
+bool sjf_set_initial(int ms);        /* 設定初始預測值 (必須為正數) */
+int sjf_remaining(Task *);           /* task 目前 burst 預測的剩餘時間 (ms) */
+void sjf_burst_end(Task *, int);     /* CPU burst 結束：記錄實際長度 (tick) 與誤差並更新預測值 */
+void sjf_insert(SjfQueue *, Task *); /* 依剩餘 burst 插入 task */
+void sjf_remove(SjfQueue *, Task *); /* 從 heap 移除 task */
+Task *sjf_first(SjfQueue *);         /* 取得剩餘 burst 最短的 task */
+
+#endif
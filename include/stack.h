@@ -0,0 +1,20 @@
+/**
+ * @file stack.h
+ * @brief Task stack 配置器的標頭檔
+ *
+ * 每個 stack 以 mmap 取得 (MAP_NORESERVE)，最低位址放一個 PROT_NONE 的 guard page，
+ * stack overflow 會直接觸發 SIGSEGV 而不是覆蓋到其他記憶體。
+ * 沒有用到的 page 不會被實際配置；TERMINATED task 的 stack 放回 free list 重複使用。
+ */
+
+#ifndef STACK_H
+#define STACK_H
+
+#include "task.h"
+
+#define STACK_WARM_SIZE (16 * 1024) /* stack 放回 free list 時保留的頂端大小，其餘 page 歸還給系統 */
+
+char *stack_alloc();        /* 取得一個 STACK_SIZE 大小的 stack，失敗回傳 NULL */
+void stack_release(char *); /* 將 stack 放回 free list */
+
+#endif
@@ -0,0 +1,42 @@
+/**
+ * @file table.h
+ * @brief Task hot table 的標頭檔
+ *
+ * 每個 tick 都會讀寫的排程欄位 (state、running、waiting、turnaround、time_quantum)
+ * 不放在 Task 結構中，而是放在以 slot 為 index 的平行陣列 (struct-of-arrays)，
+ * Task 結構只保留 context、名稱、stack 等 cold 資料。
+ * 時間統計在狀態轉換時依 state_tick 補上 (task.c 的 account)，scheduler 不會每個 tick 掃描所有 slot。
+ * task 結束並被回收 (archive) 後，它的 slot 放回 free list 給之後建立的 task 使用，
+ * 因此 table 的大小取決於同時存在的 task 數量，而不是曾經建立過的 task 數量。
+ */
+
+#ifndef TABLE_H
+#define TABLE_H
+
+#include "task.h"
+
+/*
+ * Hot table：所有陣列以 slot 為 index，長度皆為 capacity
+ */
+typedef struct TaskHot {
+    unsigned char *state; /* 當前狀態 (READY/RUNNING/WAITING/TERMINATED) */
+    int *running;         /* 累計執行時間 (單位: 10ms) */
+    int *waiting;         /* 累計等待時間 (在 ready queue 中的時間) */
+    int *turnaround;      /* Turnaround time (從建立到結束的總時間) */
+    int *time_quantum;    /* Round Robin 的剩餘時間片 (單位: 10ms) */
+    Task **task;          /* slot 所屬的 task (free slot 為 NULL，tick 不會讀取) */
+    int *free_slots;      /* 可重複使用的 slot */
+    int free_count;       /* free_slots 中的 slot 數量 */
+    int count;            /* 已使用過的 slot 數量 (含 free slot) */
+    int capacity;         /* 陣列容量 */
+} TaskHot;
+
+extern TaskHot task_hot;
+
+/* 存取 task 在 hot table 中的欄位，例如 TASK_HOT(task, state) = READY */
+#define TASK_HOT(task, field) (task_hot.field[(task)->slot])
+
+int hot_alloc(TaskHot *);      /* 配置一個新的 slot 並初始化為 READY，回傳 slot */
+void hot_free(TaskHot *, int); /* 將 slot 放回 free list (狀態設為 TERMINATED) */
+
+#endif
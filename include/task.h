@@ -3,7 +3,10 @@
 
 #include <stdbool.h>
 #include <time.h>
-#include <ucontext.h>
+#include "context.h"
+#include "hist.h"
+#include "perf.h"
+#include "reentrant.h"
 
 /* Task State Definitions */
 #define READY 0      /* READY State：在 ready queue 中等待執行 */
@@ -15,49 +18,134 @@
 #define FCFS 0 /* First Come First Serve */
 #define RR 1   /* Round Robin */
 #define PP 2   /* Priority Preemptive */
+#define CFS 3  /* Completely Fair Scheduler (cfs.h) */
+#define MLFQ 4 /* Multi-Level Feedback Queue (mlfq.h) */
+#define SJF 5  /* Shortest Job First (sjf.h) */
+#define SRTF 6 /* Shortest Remaining Time First (sjf.h) */
+#define EDF 7  /* Earliest Deadline First (edf.h) */
+#define STRIDE 8  /* Stride scheduling (share.h) */
+#define LOTTERY 9 /* Lottery scheduling (share.h) */
 
 /* System Constants */
 #define RESOURCE_SIZE 8         /* 系統資源總數 (8 個資源，ID: 0-7) */
 #define STACK_SIZE (1024 * 128) /* 每個 task 的 stack 大小 (128KB) */
+#define TICK_US (10 * 1000)     /* 一個 tick 的長度 (us) */
+
+/*
+ * task 的延遲 histogram (hist.h，單位：tick)
+ */
+typedef struct TaskLatency {
+    Histogram delay;  /* scheduling delay：進入 READY 到被 dispatch */
+    Histogram wakeup; /* wakeup latency：sleep 結束 (或重新檢查資源) 到被 dispatch */
+    Histogram burst;  /* CPU burst：兩次 sleep / 等待資源 / 結束之間累計的 running */
+} TaskLatency;
 
 /*
  * Task Control Block (TCB) 結構
  *
  * 用於儲存 task 的所有相關資訊，包括：
- * - Context: CPU 暫存器狀態 (使用 ucontext API)
+ * - Context: CPU 暫存器狀態 (asm 或 ucontext backend，見 context.h)
  * - Stack: task 專屬的執行堆疊
- * - Scheduling 相關資訊：優先權、狀態、時間統計
+ * - Scheduling 相關資訊：優先權 (狀態與時間統計等每個 tick 都會用到的欄位放在 hot table，見 table.h)
  * - Resource 管理：持有的資源陣列
  */
 typedef struct Task {
-    ucontext_t context;           /* task 的 context (CPU 暫存器狀態) */
-    char stack[STACK_SIZE];       /* task 專屬的 stack 空間 */
+    TaskContext context;          /* task 的 context (CPU 暫存器狀態) */
+    char *stack;                  /* task 專屬的 stack 空間 (由 stack pool 分配，回收時歸還) */
     char *task_name;              /* task 名稱 (唯一識別符) */
     char *function_name;          /* 要執行的函數名稱 */
     int priority;                 /* 優先權 (數值越小優先權越高) */
-    int state;                    /* 當前狀態 (READY/RUNNING/WAITING/TERMINATED) */
     int tid;                      /* Task ID (唯一編號) */
-    int running;                  /* 累計執行時間 (單位: 10ms) */
-    int waiting;                  /* 累計等待時間 (在 ready queue 中的時間) */
-    struct Task *next;            /* 指向下一個 task 的指標 (用於 linked list) */
-    int sleep_time;               /* 剩餘 sleep 時間 (單位: 10ms) */
+    int slot;                     /* 在 hot table 中的 index (state/running/waiting/turnaround/time_quantum) */
+    int cpu;                      /* 所在的 CPU (見 cpu.h) */
+    int migrations;               /* 被 work stealing / load balancing 移到其他 CPU 的次數 */
+    struct Task *prev;            /* 指向前一個 task 的指標 (用於 per-state queue) */
+    struct Task *next;            /* 指向下一個 task 的指標 (用於 per-state queue) */
+    long wake_tick;               /* sleep 結束的 tick (絕對時間，timer wheel 使用) */
+    struct Task *timer_next;      /* timer wheel slot 中的下一個 task */
+    struct Task **timer_pprev;    /* 指向前一個節點 timer_next 的指標 (不在 wheel 中時為 NULL) */
     bool resource[RESOURCE_SIZE]; /* 資源持有狀態陣列 (true: 持有, false: 未持有) */
-    int time_quantum;             /* Round Robin 的剩餘時間片 (單位: 10ms) */
-    int turnaround;               /* Turnaround time (從建立到結束的總時間) */
+    int heap_index;               /* 在 heap 中的位置 (PP overflow level、SJF、EDF、Stride 使用；Lottery 為 slot) */
+    long state_tick;              /* 進入目前狀態的 tick (tickless/virtual 模式的時間統計使用) */
+    long burst_left;              /* virtual 模式下目前 CPU burst 剩餘的 tick 數 */
+    long vruntime;                /* CFS 的 virtual runtime (us，依權重換算) */
+    struct Task *rb_parent;       /* CFS red-black tree 的 parent */
+    struct Task *rb_left;         /* CFS red-black tree 的左子節點 */
+    struct Task *rb_right;        /* CFS red-black tree 的右子節點 */
+    bool rb_red;                  /* CFS red-black tree 中節點的顏色 */
+    int mlfq_level;               /* MLFQ 中所在的 level (0 為最高) */
+    int response;                 /* Response time：加入後到第一次執行的時間 (尚未執行過為 -1) */
+    int burst_predict;            /* 預測的下一個 CPU burst 長度 (ms，見 sjf.h) */
+    int burst_last;               /* 上一個 CPU burst 的實際長度 (tick，還沒有結束過的 burst 為 -1) */
+    int burst_mark;               /* 目前的 CPU burst 開始時的 running (burst_end 更新) */
+    int burst_key;                /* 放入 SJF heap 時的剩餘 burst (ms) */
+    int burst_count;              /* 已結束的 CPU burst 數 */
+    long burst_error;             /* 每個 burst 預測誤差 (ms) 的絕對值總和 */
+    int deadline;                 /* 相對 deadline (tick，0 表示沒有 deadline，見 edf.h) */
+    int period;                   /* period (tick，0 表示只執行一次) */
+    int job_limit;                /* periodic task 執行的 job 數 (0 表示直到被刪除為止) */
+    long release;                 /* 目前 job 的 release tick */
+    long abs_deadline;            /* 目前 job 的絕對 deadline (tick，沒有 deadline 為 EDF_NONE) */
+    int jobs;                     /* 已完成的 job 數 (只計算有 deadline 的 task) */
+    int misses;                   /* 超過 deadline 才完成的 job 數 */
+    long lateness;                /* 最大 lateness：job 完成時間減去絕對 deadline (可為負) */
+    long job_response_min;        /* job 的 response time (完成時間減去 release) 的最小值 */
+    long job_response_max;        /* job 的 response time 的最大值 (jitter 為最大值減去最小值) */
+    void (*entry)(void);          /* task 函數的進入點 (periodic task 每個 job 重新呼叫) */
+    TaskContext job_context;      /* periodic task：每個 job 開始執行的位置 */
+    long pass;                    /* Stride 的 pass (見 share.h) */
+    long ready_tick;              /* 進入 READY 的 tick (喚醒時為 wake_tick，scheduling delay 使用) */
+    bool woken;                   /* 這次 READY 是否由喚醒造成 (wakeup latency 使用) */
+    TaskLatency *latency;         /* 延遲 histogram */
+    PerfCounters counters;        /* 執行期間 host 端的 CPU 時間與硬體 counter (perf.h) */
 } Task;
 
+/*
+ * 模擬結果的統計 (summary 與 all 模式的比較表使用，時間單位為 10ms)
+ */
+typedef struct TaskStats {
+    int tasks;          /* task 數 (含已回收的) */
+    int finished;       /* 已經 TERMINATED 的 task 數 */
+    double waiting;     /* 平均 waiting time (只計算 TERMINATED 的 task) */
+    double turnaround;  /* 平均 turnaround time (只計算 TERMINATED 的 task) */
+    double response;    /* 平均 response time (只計算執行過的 task) */
+    int jobs;           /* 有 deadline 的 task 完成的 job 數 */
+    int misses;         /* deadline miss 數 */
+    double share_error; /* CPU 比例與 ticket 比例的 total variation distance (0 ~ 1) */
+    long ticks;         /* 模擬經過的 tick 數 */
+    long switches;      /* 所有 CPU 的 context switch 次數 */
+    long delay_p99;     /* 所有 task 的 scheduling delay 的 p99 (tick) */
+    long wakeup_p99;    /* 所有 task 的 wakeup latency 的 p99 (tick) */
+} TaskStats;
+
 /* Task Management Functions */
 Task *get_current_task();               /* 取得當前執行中的 task */
-ucontext_t *get_current_context();      /* 取得當前的 context */
-void set_algorithm(int algo);           /* 設定排程演算法 */
+TaskContext *get_current_context();     /* 取得當前的 context */
+void set_tickless(bool enable);         /* 設定是否使用 tickless 模式 */
+void set_virtual(bool enable);          /* 設定是否使用 virtual-time 模式 */
+void set_cpus(int n);                   /* 設定模擬的 CPU 數量 */
+void set_workers(int n);                /* 設定 M:N 模式的 worker thread 數量 */
 Task *task_create(char *, char *, int); /* 建立新的 task */
+Task *task_lookup(int tid);             /* 依 tid 取得 task */
+void task_set_deadline(Task *, int, int, int);          /* 設定 deadline、period 與 job 數 (task_add 之前) */
+bool task_admit(char *, int, int, double *utilization); /* EDF 的 admission check */
 
 /* Task Operation Functions */
 void task_add(Task *); /* 將 task 加入系統，設為 READY State */
 bool task_del(char *); /* 刪除指定名稱的 task，設為 TERMINATED State */
-void task_ps();        /* 顯示所有 task 的狀態 (類似 Unix ps 命令) */
+void task_ps(bool hw); /* 顯示所有 task 的狀態 (類似 Unix ps 命令)，hw 時另外顯示硬體 counter */
+void task_summary();   /* 顯示所有 task 的平均 waiting / turnaround / response time */
+void task_stats(TaskStats *); /* 取得 summary 的統計 */
+void task_latency();   /* 顯示每個 task 與全部的延遲 percentile */
 void task_start();     /* 開始或恢復排程器執行 */
 void task_sleep(int);  /* 讓當前 task sleep 指定時間 */
 void task_exit();      /* 結束當前 task */
+void task_wait();      /* 讓當前 task 進入 WAITING 等待資源 */
+void task_burst(int);  /* virtual 模式：讓當前 task 使用 CPU 指定 tick 數 */
+void task_event(int type, int arg); /* 記錄當前 task 的事件 (event.h 的 EV_*，需在 critical section 中) */
+
+/* Scheduler critical section (M:N 模式下同時是 worker thread 之間的 lock) */
+void sched_lock();   /* 進入 critical section，期間的 SIGVTALRM 延後處理 */
+void sched_unlock(); /* 離開 critical section */
 
 #endif
@@ -0,0 +1,55 @@
+/**
+ * @file trace.h
+ * @brief Scheduler trace 檔 (binary) 的標頭檔
+ *
+ * trace on <file> 後，每個 scheduler 事件 (event.h) 以固定 32 bytes 的 record 附加到
+ * memory-mapped 的 trace 檔 (空間不足時以 ftruncate + mremap 擴充)，trace off 時截到實際長度。
+ * 檔案格式：TraceHeader 之後接著 count 個 TraceRecord；task 第一次出現時先寫一個 TRACE_NAME record，
+ * 名稱 (不含 '\0') 放在之後的 (length + 31) / 32 個 record 中。
+ * tools/tracedump 把 trace 檔轉成 Chrome trace-event JSON (可以用 Perfetto 開啟)。
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdbool.h>
+#include "event.h"
+
+#define TRACE_MAGIC "SCHEDTRC" /* 檔案開頭的 magic (8 bytes) */
+#define TRACE_VERSION 1
+#define TRACE_NAME 100         /* task 名稱的 record 類型 (其他類型與 EV_* 相同) */
+
+/*
+ * trace 檔的 header
+ */
+typedef struct TraceHeader {
+    char magic[8]; /* TRACE_MAGIC */
+    int version;   /* TRACE_VERSION */
+    int record;    /* record 大小 (sizeof(TraceRecord)) */
+    long count;    /* header 之後的 record 數 (每次 drain 後更新) */
+    long start_ns; /* trace on 時的 CLOCK_MONOTONIC (ns) */
+    int nr_cpus;   /* CPU 數量 */
+    int reserved;
+} TraceHeader;
+
+/*
+ * 一個 trace record
+ */
+typedef struct TraceRecord {
+    long tick;  /* 發生時的 jiffies */
+    long ns;    /* 發生時的 CLOCK_MONOTONIC (ns) */
+    int tid;    /* task ID (idle 為 0) */
+    short type; /* EV_* 或 TRACE_NAME */
+    short cpu;  /* 所在的 CPU */
+    int arg;    /* resource ID、job 編號，TRACE_NAME 為名稱長度 */
+    int flags;  /* EVENT_QUIET */
+} TraceRecord;
+
+extern bool trace_enabled; /* 是否正在記錄 trace */
+
+bool trace_start(const char *path); /* 開始記錄到 path (覆蓋既有檔案) */
+void trace_stop();                  /* 停止記錄並截斷檔案 */
+void trace_write(const Event *);    /* 附加一個事件 (event_drain 呼叫) */
+void trace_sync();                  /* 更新 header 中的 record 數 */
+
+#endif
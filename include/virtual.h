@@ -0,0 +1,49 @@
+/**
+ * @file virtual.h
+ * @brief Discrete-event virtual-time 模式的標頭檔
+ *
+ * --virtual 模式下不執行 function.c 中的程式碼，而是依照每個函數的 script 重現其行為：
+ * - CPU 計算以 burst profile 中的 tick 數表示 (task_burst)
+ * - sleep、資源的取得與釋放、結束則呼叫與原本函數相同的 API
+ * scheduler 不使用 timer，而是直接把 virtual clock 推進到下一個事件，
+ * 因此輸出的訊息與 ps 結果和真實 timer 下相同 burst 長度的執行一致
+ */
+
+#ifndef VIRTUAL_H
+#define VIRTUAL_H
+
+#include <stdbool.h>
+#include "task.h"
+
+/* Script 操作 */
+#define VOP_BURST 0   /* 使用 CPU，長度為該函數的 burst profile */
+#define VOP_SLEEP 1   /* task_sleep(arg) */
+#define VOP_GET 2     /* get_resources(arg, resources) */
+#define VOP_RELEASE 3 /* release_resources(arg, resources) */
+#define VOP_EXIT 4    /* task_exit() */
+
+#define BURST_FOREVER (-1) /* 永不結束的 CPU burst (idle) */
+
+/*
+ * Script 中的一個操作
+ */
+typedef struct VirtualOp {
+    int op;                       /* 操作類型 (VOP_*) */
+    int arg;                      /* SLEEP 的時間，或 GET/RELEASE 的資源數量 */
+    int resources[RESOURCE_SIZE]; /* GET/RELEASE 的資源 ID */
+} VirtualOp;
+
+/*
+ * 函數的 burst profile 與 script
+ */
+typedef struct VirtualProfile {
+    char *function_name;     /* 對應 function.c 中的函數名稱 */
+    int burst;               /* CPU burst 長度 (單位: 10ms)，BURST_FOREVER 表示永不結束 */
+    const VirtualOp *script; /* 以 VOP_EXIT 結束的操作序列 */
+} VirtualProfile;
+
+VirtualProfile *virtual_lookup(char *function_name); /* 依函數名稱取得 profile，找不到回傳 NULL */
+void virtual_profile_print();                        /* 顯示所有函數的 burst profile */
+void virtual_task();                                 /* virtual 模式下所有 task 的進入點 */
+
+#endif
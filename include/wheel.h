@@ -0,0 +1,41 @@
+/**
+ * @file wheel.h
+ * @brief Sleep timer 使用的 hierarchical timer wheel 標頭檔
+ *
+ * 以 task 的絕對喚醒 tick (wake_tick) 為 key，管理所有 sleep 中
+ * 或等待資源的 task。結構與 Linux 2.6 的 timer wheel 相同：
+ * - 第 0 層 256 個 slot，每個 slot 代表 1 個 tick
+ * - 第 1 ~ 3 層各 64 個 slot，每層的 slot 範圍為前一層的 64 倍
+ * 每個 tick 只處理第 0 層的一個 slot，每 256 個 tick 才把上一層的
+ * 一個 slot 展開 (cascade) 到下層，因此 tick 的成本與 sleep 中的 task 數量無關
+ */
+
+#ifndef WHEEL_H
+#define WHEEL_H
+
+#include "task.h"
+
+#define WHEEL_ROOT_BITS 8                        /* 第 0 層 slot 數的 bit 數 */
+#define WHEEL_LEVEL_BITS 6                       /* 第 1 ~ 3 層 slot 數的 bit 數 */
+#define WHEEL_ROOT_SIZE (1 << WHEEL_ROOT_BITS)   /* 第 0 層 slot 數 (256) */
+#define WHEEL_LEVEL_SIZE (1 << WHEEL_LEVEL_BITS) /* 第 1 ~ 3 層 slot 數 (64) */
+#define WHEEL_LEVELS 3                           /* 第 0 層以外的層數 */
+
+/*
+ * Hierarchical timer wheel
+ *
+ * slot 內以 Task 的 timer_next / timer_pprev 串成 list (hlist 形式，移除時不需知道 slot)
+ */
+typedef struct TimerWheel {
+    long next_tick;                              /* 下一個要處理的 tick */
+    int count;                                   /* wheel 中的 task 數量 */
+    Task *root[WHEEL_ROOT_SIZE];                 /* 第 0 層 */
+    Task *level[WHEEL_LEVELS][WHEEL_LEVEL_SIZE]; /* 第 1 ~ 3 層 */
+} TimerWheel;
+
+void wheel_add(TimerWheel *, Task *);                     /* 依 task->wake_tick 加入 wheel */
+void wheel_remove(TimerWheel *, Task *);                  /* 從 wheel 移除 task */
+int wheel_run(TimerWheel *, long tick, void (*)(Task *)); /* 處理到指定 tick，回傳喚醒的 task 數 */
+long wheel_next_expiry(TimerWheel *);                     /* 下一個需要處理的 tick，wheel 為空時回傳 -1 */
+
+#endif
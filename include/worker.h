@@ -0,0 +1,27 @@
+/**
+ * @file worker.h
+ * @brief M:N 模式的 kernel worker thread 標頭檔
+ *
+ * M:N 模式 (--workers K) 下每個 CPU (cpu.h) 由一個 kernel thread 執行，
+ * 各自執行 scheduler 主迴圈並在自己的 CPU 上切換 task；task 之間仍以 context switch 切換。
+ * 每個 worker 有自己的 per-thread timer (timer_create + SIGEV_THREAD_ID，
+ * 以該 thread 的 CPU time 計時)，SIGVTALRM 只送到該 worker。
+ */
+
+#ifndef WORKER_H
+#define WORKER_H
+
+#include <stdbool.h>
+
+#define WORKER_MAX 64      /* --workers 的上限 */
+#define WORKER_CODE_MAX 16 /* 執行檔之外可以切換 task 的 code 範圍數 (plugin) */
+
+extern int nr_workers; /* worker thread 數量，0 表示不使用 M:N 模式 */
+
+void worker_run(void *(*main)(void *));       /* 建立 nr_workers 個 thread 執行 main (參數為 CPU 編號)，等待全部結束 */
+void worker_timer_start();                    /* 為目前的 worker 建立並啟動 10ms 的 per-thread timer */
+void worker_timer_stop();                     /* 刪除目前 worker 的 timer */
+bool worker_safe_point(void *ucontext);       /* signal 打斷的位置是否可以切換 task (不在 libc 中) */
+void worker_code_add(char *start, char *end); /* 將 [start, end) 加入可以切換 task 的 code 範圍 */
+
+#endif
@@ -2,8 +2,15 @@
 #include <stdlib.h>
 #include <string.h>
 #include "include/command.h"
+#include "include/compare.h"
+#include "include/cpu.h"
+#include "include/mlfq.h"
+#include "include/policy.h"
+#include "include/registry.h"
 #include "include/shell.h"
+#include "include/sjf.h"
 #include "include/task.h"
+#include "include/worker.h"
 
 /*
  * Main Program Entry Point
@@ -11,7 +18,7 @@
  * 功能：
  * 1. 解析命令列參數，決定使用哪種 scheduling algorithm
  * 2. 初始化 shell 的歷史記錄緩衝區
- * 3. 設定選定的排程演算法
+ * 3. 設定選定的排程演算法 (policy.h)
  * 4. 啟動互動式 shell
  * 5. 清理記憶體並結束程式
  */
@@ -25,29 +32,90 @@ int main(int argc, char *argv[])
         history[i] = (char *) malloc(BUF_SIZE * sizeof(char));
     }
 
-    /* 檢查命令列參數數量是否正確 */
-    if (argc < 2) {
-        printf("Usage: %s {algorithm}\n", argv[0]);
-        printf("  Valid algorithm: FCFS / RR / PP\n");
-        return 0;
+    /*
+     * 選項：
+     * --tickless 使用 one-shot timer，只在下一個事件時觸發
+     * --virtual  不使用 timer，依 burst profile 以 virtual clock 模擬
+     * --ucontext 使用 glibc ucontext 切換 context (預設為手寫的 asm backend)
+     * --cpus N   模擬 N 個 CPU (不能與 --tickless 同時使用)
+     * --workers K  M:N 模式：K 個 kernel thread 各執行一個 CPU (不能與 --tickless / --virtual / --cpus 同時使用)
+     * --mlfq-quantum Q0,Q1,...  MLFQ 的 level 數與各 level 的時間片 (ms，預設 10,20,40)
+     * --mlfq-boost MS           MLFQ 的 priority boost 週期 (ms，預設 500)
+     * --sjf-alpha A             SJF/SRTF 預測 CPU burst 的指數平均 alpha (0 ~ 1，預設 0.5)
+     * --sjf-initial MS          SJF/SRTF 第一個 CPU burst 的預測值 (ms，預設 100)
+     * --rr-quantum MS           RR 的時間片 (ms，10 的倍數，預設 30)
+     */
+    int ncpus = 1;
+    int nworkers = 0;
+    bool tickless = false;
+    bool virtual = false;
+    bool invalid = false;
+    int arg = 1;
+    for (; arg < argc && strncmp(argv[arg], "--", 2) == 0; arg++) {
+        if (strcmp(argv[arg], "--tickless") == 0) {
+            tickless = true;
+            set_tickless(true);
+        } else if (strcmp(argv[arg], "--virtual") == 0) {
+            virtual = true;
+            set_virtual(true);
+        } else if (strcmp(argv[arg], "--ucontext") == 0) {
+            context_set_backend(CONTEXT_UCONTEXT);
+        } else if (strcmp(argv[arg], "--cpus") == 0 && arg + 1 < argc) {
+            ncpus = atoi(argv[++arg]);
+        } else if (strcmp(argv[arg], "--workers") == 0 && arg + 1 < argc) {
+            nworkers = atoi(argv[++arg]);
+            if (nworkers < 1 || nworkers > WORKER_MAX) {
+                nworkers = -1;
+            }
+        } else if (strcmp(argv[arg], "--mlfq-quantum") == 0 && arg + 1 < argc) {
+            invalid |= !mlfq_set_quantum(argv[++arg]);
+        } else if (strcmp(argv[arg], "--mlfq-boost") == 0 && arg + 1 < argc) {
+            invalid |= !mlfq_set_boost(atoi(argv[++arg]));
+        } else if (strcmp(argv[arg], "--sjf-alpha") == 0 && arg + 1 < argc) {
+            invalid |= !sjf_set_alpha(atof(argv[++arg]));
+        } else if (strcmp(argv[arg], "--sjf-initial") == 0 && arg + 1 < argc) {
+            invalid |= !sjf_set_initial(atoi(argv[++arg]));
+        } else if (strcmp(argv[arg], "--rr-quantum") == 0 && arg + 1 < argc) {
+            invalid |= !rr_set_quantum(atoi(argv[++arg]));
+        } else {
+            break;
+        }
     }
 
-    /* Set scheduling algorithm based on user input */
-    if (strcmp(argv[1], "FCFS") == 0) {
-        set_algorithm(FCFS);
-    } else if (strcmp(argv[1], "RR") == 0) {
-        set_algorithm(RR);
-    } else if (strcmp(argv[1], "PP") == 0) {
-        set_algorithm(PP);
-    } else {
-        /* Invalid algorithm parameter, display usage instructions */
-        printf("Usage: %s {algorithm}\n", argv[0]);
-        printf("  Valid algorithm: FCFS / RR / PP\n");
+    /* 檢查命令列參數，並依名稱取得排程演算法 (all 同時執行 FCFS / RR / PP 並比較，見 compare.h) */
+    bool all = arg < argc && strcmp(argv[arg], "all") == 0;
+    const Policy *policy = arg < argc ? policy_find(argv[arg]) : NULL;
+    if ((policy == NULL && !all) || invalid || ncpus < 1 || ncpus > CPU_MAX || (tickless && virtual) ||
+        (ncpus > 1 && tickless) || nworkers < 0 || (nworkers > 0 && (tickless || virtual || ncpus > 1))) {
+        char names[128];
+        policy_names(names, sizeof(names));
+        printf("Usage: %s [--tickless | --virtual] [--ucontext] [--cpus N | --workers K] "
+               "[--mlfq-quantum Q0,Q1,...] [--mlfq-boost MS] [--sjf-alpha A] [--sjf-initial MS] [--rr-quantum MS] "
+               "{algorithm}\n",
+               argv[0]);
+        printf("  Valid algorithm: %s / all\n", names);
         return 0;
     }
+    if (policy != NULL) {
+        set_policy(policy);
+    }
 
-    /* 啟動互動式 shell，進入主要的命令處理迴圈 */
-    shell();
+    if (ncpus > 1) {
+        set_cpus(ncpus);
+    }
+    if (nworkers > 0) {
+        set_workers(nworkers);
+    }
+
+    /* 登錄 function.c 的內建 task 函數 (load 命令可再加入 plugin 的函數) */
+    registry_init();
+
+    /* 啟動互動式 shell，進入主要的命令處理迴圈 (all 模式下每個演算法的 child 各自執行 shell) */
+    if (all) {
+        compare_all();
+    } else {
+        shell();
+    }
 
     /* Free allocated memory for history */
     for (int i = 0; i < MAX_RECORD_NUM; ++i) {
@@ -0,0 +1,52 @@
+/**
+ * @file example.c
+ * @brief load 命令使用的範例 plugin
+ *
+ * 編譯：make plugin
+ * 使用：load ./plugin/example.so 之後即可 add T1 fib 1
+ */
+
+#include "../include/registry.h"
+#include "../include/task.h"
+
+/*
+ * 遞迴計算 Fibonacci 數 (CPU 密集型)
+ */
+static long fib(int n)
+{
+    return n < 2 ? n : fib(n - 1) + fib(n - 2);
+}
+
+/*
+ * CPU 密集型 task：重複計算 fib(30)
+ */
+static void fib_task()
+{
+    volatile long sum = 0;
+    for (int i = 0; i < 20; i++) {
+        sum += fib(30);
+    }
+    task_exit();
+    while (1); /* 防護性無窮迴圈 */
+}
+
+/*
+ * 交替計算與 sleep 的 task (I/O 型的負載)
+ */
+static void burst_sleep()
+{
+    volatile long sum = 0;
+    for (int i = 0; i < 5; i++) {
+        sum += fib(25);
+        task_sleep(5);
+    }
+    task_exit();
+    while (1); /* 防護性無窮迴圈 */
+}
+
+/* 匯出的 task 函數表 (registry.h) */
+const TaskFunction task_functions[] = {
+    {"fib", fib_task},
+    {"burst_sleep", burst_sleep},
+    {NULL, NULL},
+};
@@ -0,0 +1,122 @@
+/**
+ * @file archive.c
+ * @brief 已結束 task 的 archive 實作檔
+ */
+
+#include "../include/archive.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/table.h"
+
+/*
+ * 記錄 task 的最終資料 (呼叫者之後會釋放 task)
+ */
+void archive_add(TaskArchive *archive, Task *task)
+{
+    size_t length = strlen(task->task_name) + 1;
+
+    if (archive->count == archive->capacity) {
+        int capacity = (archive->capacity == 0) ? 64 : archive->capacity * 2;
+        ArchiveEntry *entries = realloc(archive->entries, capacity * sizeof(ArchiveEntry));
+        if (entries == NULL) {
+            perror("archive_add");
+            exit(1);
+        }
+        archive->entries = entries;
+        archive->capacity = capacity;
+    }
+    if (archive->names_used + length > archive->names_capacity) {
+        size_t capacity = (archive->names_capacity == 0) ? 1024 : archive->names_capacity;
+        while (archive->names_used + length > capacity) {
+            capacity *= 2;
+        }
+        char *names = realloc(archive->names, capacity);
+        if (names == NULL) {
+            perror("archive_add");
+            exit(1);
+        }
+        archive->names = names;
+        archive->names_capacity = capacity;
+    }
+
+    if (archive->latency_used + 3 * (1 + HIST_BUCKETS) > archive->latency_capacity) {
+        size_t capacity = (archive->latency_capacity == 0) ? 4096 : archive->latency_capacity * 2;
+        HistPair *latency = realloc(archive->latency, capacity * sizeof(HistPair));
+        if (latency == NULL) {
+            perror("archive_add");
+            exit(1);
+        }
+        archive->latency = latency;
+        archive->latency_capacity = capacity;
+    }
+
+    ArchiveEntry *entry = &archive->entries[archive->count++];
+    entry->tid = task->tid;
+    entry->priority = task->priority;
+    entry->cpu = task->cpu;
+    entry->migrations = task->migrations;
+    entry->vruntime = task->vruntime;
+    entry->mlfq_level = task->mlfq_level;
+    entry->response = task->response;
+    entry->burst_predict = task->burst_predict;
+    entry->burst_last = task->burst_last;
+    entry->burst_count = task->burst_count;
+    entry->burst_error = task->burst_error;
+    entry->deadline = task->deadline;
+    entry->period = task->period;
+    entry->jobs = task->jobs;
+    entry->misses = task->misses;
+    entry->lateness = task->lateness;
+    entry->jitter = task->job_response_max - task->job_response_min;
+    entry->running = TASK_HOT(task, running);
+    entry->waiting = TASK_HOT(task, waiting);
+    entry->turnaround = TASK_HOT(task, turnaround);
+    entry->counters = task->counters;
+    entry->name = archive->names_used;
+    entry->latency = archive->latency_used;
+    archive->latency_used += hist_pack(&task->latency->delay, archive->latency + archive->latency_used);
+    archive->latency_used += hist_pack(&task->latency->wakeup, archive->latency + archive->latency_used);
+    archive->latency_used += hist_pack(&task->latency->burst, archive->latency + archive->latency_used);
+    entry->resources = 0;
+    for (int i = 0; i < RESOURCE_SIZE; i++) {
+        if (task->resource[i]) {
+            entry->resources |= 1 << i;
+        }
+    }
+    memcpy(archive->names + archive->names_used, task->task_name, length);
+    archive->names_used += length;
+}
+
+/*
+ * 取得 entry 的 task 名稱
+ */
+const char *archive_name(TaskArchive *archive, ArchiveEntry *entry)
+{
+    return archive->names + entry->name;
+}
+
+/*
+ * 依名稱尋找最早結束的 entry
+ * 回傳值：entry 指標，找不到回傳 NULL
+ */
+ArchiveEntry *archive_find(TaskArchive *archive, const char *name)
+{
+    for (int i = 0; i < archive->count; i++) {
+        if (strcmp(archive->names + archive->entries[i].name, name) == 0) {
+            return &archive->entries[i];
+        }
+    }
+    return NULL;
+}
+
+/*
+ * 還原 entry 的延遲 histogram
+ */
+void archive_latency(TaskArchive *archive, ArchiveEntry *entry, TaskLatency *latency)
+{
+    const HistPair *in = archive->latency + entry->latency;
+    in += hist_unpack(&latency->delay, in);
+    in += hist_unpack(&latency->wakeup, in);
+    hist_unpack(&latency->burst, in);
+}
@@ -8,7 +8,11 @@
 #include <sys/types.h>
 #include <unistd.h>
 #include "../include/command.h"
+#include "../include/overhead.h"
+#include "../include/registry.h"
 #include "../include/task.h"
+#include "../include/trace.h"
+#include "../include/virtual.h"
 
 /*
  * Display help information
@@ -85,6 +89,7 @@ int echo(char **args)
  */
 int exit_shell(char **args)
 {
+    trace_stop(); /* 截斷尚未停止的 trace 檔 */
     return 0;
 }
 
@@ -215,8 +220,14 @@ int mypid(char **args)
  *   args[1] - task 名稱
  *   args[2] - 要執行的函數名稱
  *   args[3] - 優先權 (數值越小優先權越高)
+ *   args[4] - (選用) 相對 deadline (單位: 10ms)，0 表示沒有 deadline (或與 period 相同)
+ *   args[5] - (選用) period (單位: 10ms)，函數結束後每個 period 重新執行一次
+ *   args[6] - (選用) periodic task 執行的 job 數，省略或 0 表示直到被 del 為止
+ *
+ * 有 deadline 時先做 EDF 的 admission check (utilization 總和不可超過 CPU 數量)
  *
  * 使用範例：add T1 test_exit 5
+ *           add T2 task3 0 30 50 10
  */
 int add(char **args)
 {
@@ -232,15 +243,36 @@ int add(char **args)
         return 1;
     }
 
+    /* 驗證選用的 deadline、period 與 job 數 */
+    static const char *timing_name[] = {"deadline", "period", "job count"};
+    int timing[3] = {0, 0, 0};
+    for (int i = 0; i < 3 && args[4 + i] != NULL; i++) {
+        if (!isnum(args[4 + i]) || strlen(args[4 + i]) == 0) {
+            printf("add: %s is not a valid number\n", timing_name[i]);
+            return 1;
+        }
+        timing[i] = atoi(args[4 + i]);
+    }
+
     char *task_name = args[1];
     char *function_name = args[2];
     int priority = atoi(args[3]);
 
+    /* EDF：加入後 utilization 超過 CPU 數量時無法保證 deadline */
+    double utilization;
+    if (!task_admit(function_name, timing[0], timing[1], &utilization)) {
+        printf("add: task %s is rejected (utilization %.2f)\n", task_name, utilization);
+        return 1;
+    }
+
     /* 建立新 task */
     Task *task = task_create(task_name, function_name, priority);
     if (task == NULL) {
         printf("Create task failed.\n");
     } else {
+        if (timing[0] > 0 || timing[1] > 0) {
+            task_set_deadline(task, timing[0], timing[1], timing[2]);
+        }
         /* 加入 task 到 scheduler queue */
         task_add(task);
         printf("Task %s is ready.\n", task_name);
@@ -278,10 +310,55 @@ int del(char **args)
  * Display all task's status information
  *
  * 類似 Unix 的 ps 命令，顯示 task 列表和其狀態
+ * ps -hw 另外顯示每個 task 的 host CPU 時間、IPC 與 cache / TLB miss (perf.h)
  */
 int ps(char **args)
 {
-    task_ps();
+    if (args[1] != NULL && strcmp(args[1], "-hw") != 0) {
+        printf("ps: unknown option %s\n", args[1]);
+        return 1;
+    }
+    task_ps(args[1] != NULL);
+    return 1;
+}
+
+/*
+ * 顯示所有 task 的平均 waiting / turnaround / response time
+ *
+ * 以相同的輸入分別用不同的演算法執行後比較 (見 test/compare.py)
+ */
+int summary(char **args)
+{
+    task_summary();
+    return 1;
+}
+
+/*
+ * 顯示每個 task 與所有 task 的 scheduling delay / wakeup latency / CPU burst 的
+ * p50/p90/p99/max (平均值看不出 tail latency)
+ */
+int stats(char **args)
+{
+    task_latency();
+    return 1;
+}
+
+/*
+ * 顯示或清除 scheduler overhead 的量測結果 (overhead.h)
+ *
+ * 參數：args[1] - reset 時清除 (比較不同的工作負載前使用)
+ *
+ * 顯示 handler 每個 tick 的時間、switch latency 的分布與 scheduler 占 CPU 時間的比例
+ */
+int overhead(char **args)
+{
+    if (args[1] != NULL && strcmp(args[1], "reset") == 0) {
+        overhead_reset();
+    } else if (args[1] != NULL) {
+        printf("overhead: unknown option %s\n", args[1]);
+    } else {
+        overhead_print();
+    }
     return 1;
 }
 
@@ -298,6 +375,87 @@ int start(char **args)
     return 1;
 }
 
+/*
+ * 設定或顯示 virtual 模式下函數的 CPU burst 長度
+ *
+ * 參數：
+ *   args[1] - 函數名稱 (省略時顯示所有函數的 burst)
+ *   args[2] - burst 長度 (單位: 10ms)，forever 表示永不結束
+ *
+ * 使用範例：burst task1 40
+ */
+int burst(char **args)
+{
+    if (args[1] == NULL) {
+        virtual_profile_print();
+        return 1;
+    }
+    if (args[2] == NULL) {
+        printf("burst: too few argument\n");
+        return 1;
+    }
+
+    VirtualProfile *profile = virtual_lookup(args[1]);
+    if (profile == NULL) {
+        printf("burst: unknown function %s\n", args[1]);
+        return 1;
+    }
+    if (strcmp(args[2], "forever") == 0) {
+        profile->burst = BURST_FOREVER;
+    } else if (isnum(args[2]) && strlen(args[2]) > 0) {
+        profile->burst = atoi(args[2]);
+    } else {
+        printf("burst: length is not a valid number\n");
+    }
+    return 1;
+}
+
+/*
+ * 載入 task 函數的 plugin
+ *
+ * 參數：args[1] - shared object 的路徑 (不含 '/' 時依 dlopen 的規則搜尋)
+ *
+ * 使用範例：load ./plugin/example.so
+ */
+int load(char **args)
+{
+    if (args[1] == NULL) {
+        printf("load: too few argument\n");
+        return 1;
+    }
+
+    int count = registry_load(args[1]);
+    if (count >= 0) {
+        printf("Loaded %d task functions from %s.\n", count, args[1]);
+    }
+    return 1;
+}
+
+/*
+ * 開始或停止記錄 scheduler trace (trace.h)
+ *
+ * 參數：args[1] - on 或 off；args[2] - trace 檔的路徑 (on 時，覆蓋既有檔案)
+ *
+ * 使用範例：trace on sched.trace，之後以 tools/tracedump sched.trace > sched.json 轉換
+ */
+int trace(char **args)
+{
+    if (args[1] == NULL) {
+        printf("trace: too few argument\n");
+    } else if (strcmp(args[1], "on") == 0) {
+        if (args[2] == NULL) {
+            printf("trace: too few argument\n");
+        } else if (trace_start(args[2])) {
+            printf("Tracing to %s.\n", args[2]);
+        }
+    } else if (strcmp(args[1], "off") == 0) {
+        trace_stop();
+    } else {
+        printf("trace: unknown option %s\n", args[1]);
+    }
+    return 1;
+}
+
 /*
  * Builtin command name array
  *
@@ -313,7 +471,13 @@ const char *builtin_str[] = {
     "add",    /* 新增 task */
     "del",    /* 刪除 task */
     "ps",     /* 顯示 task 狀態 */
-    "start"   /* 開始模擬 */
+    "start",  /* 開始模擬 */
+    "burst",  /* virtual 模式的 CPU burst */
+    "load",   /* 載入 plugin */
+    "summary", /* 平均時間統計 */
+    "trace",   /* scheduler trace */
+    "stats",   /* 延遲 percentile */
+    "overhead" /* scheduler overhead */
 };
 
 /*
@@ -321,7 +485,7 @@ const char *builtin_str[] = {
  *
  * 與 builtin_str 陣列一一對應
  */
-const int (*builtin_func[])(char **) = {&help, &cd, &echo, &exit_shell, &record, &mypid, &add, &del, &ps, &start};
+const int (*builtin_func[])(char **) = {&help, &cd, &echo, &exit_shell, &record, &mypid, &add, &del, &ps, &start, &burst, &load, &summary, &trace, &stats, &overhead};
 
 /*
  * 取得內建命令的數量
@@ -0,0 +1,349 @@
+/**
+ * @file cfs.c
+ * @brief CFS (Completely Fair Scheduler) 的實作檔
+ *
+ * Red-black tree 的節點直接使用 Task 中的 rb_parent / rb_left / rb_right / rb_red
+ * (每個 task 同一時間只會在一個 queue 中，與 prev/next 相同)。
+ */
+
+#include "../include/cfs.h"
+#include <stddef.h>
+
+/*
+ * nice -20 ~ 19 對應的權重 (與 Linux 的 sched_prio_to_weight 相同，相鄰 nice 約差 1.25 倍)
+ */
+static const int nice_to_weight[40] = {
+    88761, 71755, 56483, 46273, 36291, /* -20 ~ -16 */
+    29154, 23254, 18705, 14949, 11916, /* -15 ~ -11 */
+    9548,  7620,  6100,  4904,  3906,  /* -10 ~ -6 */
+    3121,  2501,  1991,  1586,  1277,  /* -5 ~ -1 */
+    1024,  820,   655,   526,   423,   /* 0 ~ 4 */
+    335,   272,   215,   172,   137,   /* 5 ~ 9 */
+    110,   87,    70,    56,    45,    /* 10 ~ 14 */
+    36,    29,    23,    18,    15,    /* 15 ~ 19 */
+};
+
+/*
+ * priority 對應的 nice 值：priority 20 為 nice 0，數值越小優先權越高 (與 PP 相同)
+ */
+int cfs_nice(int priority)
+{
+    int nice = priority - CFS_NICE_OFFSET;
+    return nice < -20 ? -20 : (nice > 19 ? 19 : nice);
+}
+
+/*
+ * priority 對應的權重
+ */
+int cfs_weight(int priority)
+{
+    return nice_to_weight[cfs_nice(priority) + 20];
+}
+
+/*
+ * tree 的順序：vruntime 小的在左邊，相同時依 tid (加入順序)
+ */
+static bool cfs_less(Task *a, Task *b)
+{
+    if (a->vruntime != b->vruntime) {
+        return a->vruntime < b->vruntime;
+    }
+    return a->tid < b->tid;
+}
+
+/*
+ * 以 child 取代 parent 下的 old (old 為 root 時更新 root)
+ */
+static void replace_child(CfsQueue *q, Task *parent, Task *old, Task *child)
+{
+    if (parent == NULL) {
+        q->root = child;
+    } else if (parent->rb_left == old) {
+        parent->rb_left = child;
+    } else {
+        parent->rb_right = child;
+    }
+    if (child != NULL) {
+        child->rb_parent = parent;
+    }
+}
+
+/*
+ * 左旋：x 的右子節點成為 x 的 parent
+ */
+static void rotate_left(CfsQueue *q, Task *x)
+{
+    Task *y = x->rb_right;
+    x->rb_right = y->rb_left;
+    if (y->rb_left != NULL) {
+        y->rb_left->rb_parent = x;
+    }
+    replace_child(q, x->rb_parent, x, y);
+    y->rb_left = x;
+    x->rb_parent = y;
+}
+
+/*
+ * 右旋：x 的左子節點成為 x 的 parent
+ */
+static void rotate_right(CfsQueue *q, Task *x)
+{
+    Task *y = x->rb_left;
+    x->rb_left = y->rb_right;
+    if (y->rb_right != NULL) {
+        y->rb_right->rb_parent = x;
+    }
+    replace_child(q, x->rb_parent, x, y);
+    y->rb_right = x;
+    x->rb_parent = y;
+}
+
+static bool is_red(Task *task)
+{
+    return task != NULL && task->rb_red;
+}
+
+/*
+ * 插入 task (O(log n))，並更新 leftmost 與權重總和
+ */
+void cfs_insert(CfsQueue *q, Task *task)
+{
+    Task *parent = NULL;
+    Task **link = &q->root;
+    bool leftmost = true;
+
+    while (*link != NULL) {
+        parent = *link;
+        if (cfs_less(task, parent)) {
+            link = &parent->rb_left;
+        } else {
+            link = &parent->rb_right;
+            leftmost = false;
+        }
+    }
+    task->rb_parent = parent;
+    task->rb_left = NULL;
+    task->rb_right = NULL;
+    task->rb_red = true;
+    *link = task;
+    if (leftmost) {
+        q->leftmost = task;
+    }
+    q->count++;
+    q->load += cfs_weight(task->priority);
+
+    /* 修正連續的紅色節點 */
+    Task *node = task;
+    while (is_red(node->rb_parent)) {
+        Task *p = node->rb_parent;
+        Task *g = p->rb_parent; /* p 為紅色，一定不是 root */
+        Task *uncle = (g->rb_left == p) ? g->rb_right : g->rb_left;
+        if (is_red(uncle)) {
+            p->rb_red = false;
+            uncle->rb_red = false;
+            g->rb_red = true;
+            node = g;
+            continue;
+        }
+        if (g->rb_left == p) {
+            if (p->rb_right == node) {
+                rotate_left(q, p);
+                node = p;
+                p = node->rb_parent;
+            }
+            rotate_right(q, g);
+        } else {
+            if (p->rb_left == node) {
+                rotate_right(q, p);
+                node = p;
+                p = node->rb_parent;
+            }
+            rotate_left(q, g);
+        }
+        p->rb_red = false;
+        g->rb_red = true;
+        break;
+    }
+    q->root->rb_red = false;
+}
+
+/*
+ * 移除 task (O(log n))，並更新 leftmost 與權重總和
+ */
+void cfs_remove(CfsQueue *q, Task *task)
+{
+    Task *child, *parent;
+    bool removed_red;
+
+    if (q->leftmost == task) {
+        /* 下一個最小的節點：右子樹的最左邊，沒有右子樹時為 parent */
+        if (task->rb_right != NULL) {
+            Task *next = task->rb_right;
+            while (next->rb_left != NULL) {
+                next = next->rb_left;
+            }
+            q->leftmost = next;
+        } else {
+            q->leftmost = task->rb_parent;
+        }
+    }
+    q->count--;
+    q->load -= cfs_weight(task->priority);
+
+    if (task->rb_left == NULL || task->rb_right == NULL) {
+        /* 最多一個子節點：直接以子節點取代 */
+        child = task->rb_left != NULL ? task->rb_left : task->rb_right;
+        parent = task->rb_parent;
+        removed_red = task->rb_red;
+        replace_child(q, parent, task, child);
+    } else {
+        /* 兩個子節點：以右子樹最小的節點 (successor) 取代 task 的位置 */
+        Task *succ = task->rb_right;
+        while (succ->rb_left != NULL) {
+            succ = succ->rb_left;
+        }
+        child = succ->rb_right;
+        removed_red = succ->rb_red;
+        if (succ->rb_parent == task) {
+            parent = succ;
+        } else {
+            parent = succ->rb_parent;
+            replace_child(q, parent, succ, child);
+            succ->rb_right = task->rb_right;
+            succ->rb_right->rb_parent = succ;
+        }
+        replace_child(q, task->rb_parent, task, succ);
+        succ->rb_left = task->rb_left;
+        succ->rb_left->rb_parent = succ;
+        succ->rb_red = task->rb_red;
+    }
+    task->rb_parent = task->rb_left = task->rb_right = NULL;
+
+    if (removed_red) {
+        return;
+    }
+
+    /* 移除黑色節點：child 所在的路徑少了一個黑色節點，往上修正 */
+    while (child != q->root && !is_red(child)) {
+        if (parent->rb_left == child) {
+            Task *sibling = parent->rb_right;
+            if (is_red(sibling)) {
+                sibling->rb_red = false;
+                parent->rb_red = true;
+                rotate_left(q, parent);
+                sibling = parent->rb_right;
+            }
+            if (!is_red(sibling->rb_left) && !is_red(sibling->rb_right)) {
+                sibling->rb_red = true;
+                child = parent;
+                parent = child->rb_parent;
+                continue;
+            }
+            if (!is_red(sibling->rb_right)) {
+                sibling->rb_left->rb_red = false;
+                sibling->rb_red = true;
+                rotate_right(q, sibling);
+                sibling = parent->rb_right;
+            }
+            sibling->rb_red = parent->rb_red;
+            parent->rb_red = false;
+            sibling->rb_right->rb_red = false;
+            rotate_left(q, parent);
+        } else {
+            Task *sibling = parent->rb_left;
+            if (is_red(sibling)) {
+                sibling->rb_red = false;
+                parent->rb_red = true;
+                rotate_right(q, parent);
+                sibling = parent->rb_left;
+            }
+            if (!is_red(sibling->rb_left) && !is_red(sibling->rb_right)) {
+                sibling->rb_red = true;
+                child = parent;
+                parent = child->rb_parent;
+                continue;
+            }
+            if (!is_red(sibling->rb_left)) {
+                sibling->rb_right->rb_red = false;
+                sibling->rb_red = true;
+                rotate_left(q, sibling);
+                sibling = parent->rb_left;
+            }
+            sibling->rb_red = parent->rb_red;
+            parent->rb_red = false;
+            sibling->rb_left->rb_red = false;
+            rotate_right(q, parent);
+        }
+        child = q->root;
+    }
+    if (child != NULL) {
+        child->rb_red = false;
+    }
+}
+
+/*
+ * 取得 vruntime 最小的 task (O(1))
+ */
+Task *cfs_first(CfsQueue *q)
+{
+    return q->leftmost;
+}
+
+/*
+ * task 執行 us 微秒：vruntime 增加 us * NICE_0_WEIGHT / weight
+ * (權重越大 vruntime 增加得越慢，因此分到越多 CPU 時間)
+ */
+void cfs_charge(Task *task, long us)
+{
+    task->vruntime += us * CFS_NICE_0_WEIGHT / cfs_weight(task->priority);
+}
+
+/*
+ * 推進 min_vruntime：取執行中的 task 與 leftmost 中較小的 vruntime，但不會倒退
+ */
+void cfs_update_min(CfsQueue *q, Task *current)
+{
+    long vruntime = -1;
+    if (current != NULL) {
+        vruntime = current->vruntime;
+    }
+    if (q->leftmost != NULL && (vruntime < 0 || q->leftmost->vruntime < vruntime)) {
+        vruntime = q->leftmost->vruntime;
+    }
+    if (vruntime > q->min_vruntime) {
+        q->min_vruntime = vruntime;
+    }
+}
+
+/*
+ * task 這次 dispatch 的時間片 (ms)
+ *
+ * period 為 target latency，READY task 太多時延長為 count * minimum granularity；
+ * task 分到 period 中依權重的比例 (task 仍在 tree 中，load 已包含它的權重)，
+ * 再取 minimum granularity (一個 tick) 的倍數，讓時間片剛好在 tick 上用完
+ */
+int cfs_slice(CfsQueue *q, Task *task)
+{
+    long period = CFS_LATENCY_MS;
+    if (q->count * CFS_MIN_GRANULARITY_MS > period) {
+        period = q->count * CFS_MIN_GRANULARITY_MS;
+    }
+    long slice = q->load > 0 ? period * cfs_weight(task->priority) / q->load : period;
+    slice -= slice % CFS_MIN_GRANULARITY_MS;
+    return slice < CFS_MIN_GRANULARITY_MS ? CFS_MIN_GRANULARITY_MS : (int) slice;
+}
+
+/*
+ * 新加入的 task 從 min_vruntime 開始，不會因為 vruntime 為 0 而長時間佔用 CPU；
+ * sleep 後喚醒的 task 最多補償半個 target latency (sleeper credit)
+ */
+void cfs_place(CfsQueue *q, Task *task, bool waking)
+{
+    long vruntime = q->min_vruntime;
+    if (waking) {
+        vruntime -= CFS_LATENCY_MS * 1000L / 2;
+    }
+    if (task->vruntime < vruntime) {
+        task->vruntime = vruntime;
+    }
+}
@@ -15,6 +15,10 @@
 #include <stdlib.h>
 #include <string.h>
 
+/* 命令歷史記錄 (宣告於 command.h) */
+char *history[MAX_RECORD_NUM];
+int history_count;
+
 /**
  * @brief 從標準輸入讀取一行命令
  * @return 指向包含使用者輸入命令的字串指標，失敗或空輸入時返回 NULL
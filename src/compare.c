@@ -0,0 +1,254 @@
+/**
+ * @file compare.c
+ * @brief all 模式的實作檔
+ *
+ * 每個 child 的 stdin 是一份輸入的複本 (各自的 file offset)，stdout 寫到暫存檔；
+ * shell 結束後 child 把 task_stats 的結果經由 pipe 交給 parent。
+ */
+
+#define _GNU_SOURCE
+#include "../include/compare.h"
+#include <sched.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "../include/policy.h"
+#include "../include/shell.h"
+
+static const char *algorithms[] = {"FCFS", "RR", "PP"}; /* all 模式比較的演算法 */
+
+#define NR_ALGORITHMS (int) (sizeof(algorithms) / sizeof(algorithms[0]))
+
+/*
+ * 一個演算法的執行
+ */
+typedef struct CompareRun {
+    const Policy *policy; /* 使用的演算法 (建置中不包含時為 NULL) */
+    pid_t pid;            /* child process */
+    FILE *log;            /* child 的 stdout */
+    int result;           /* 讀取 TaskStats 的 pipe */
+    TaskStats stats;      /* child 回傳的統計 */
+    bool done;            /* 是否取得統計 (child 異常結束時為 false) */
+} CompareRun;
+
+/*
+ * 讀入 stdin 的所有內容，最後加上 exit (輸入沒有 exit 時 shell 才會結束)
+ * 回傳值：以 '\0' 結尾的輸入
+ */
+static char *read_input(size_t *length)
+{
+    size_t capacity = 4096, len = 0, n;
+    char *buf = (char *) malloc(capacity);
+    while (buf != NULL && (n = fread(buf + len, 1, capacity - len - 1, stdin)) > 0) {
+        len += n;
+        if (capacity - len - 1 < 4096) {
+            capacity *= 2;
+            buf = (char *) realloc(buf, capacity);
+        }
+    }
+    if (buf == NULL || (buf = (char *) realloc(buf, len + 8)) == NULL) {
+        perror("compare_all");
+        exit(1);
+    }
+    len += sprintf(buf + len, "\nexit\n");
+    *length = len;
+    return buf;
+}
+
+/*
+ * Child：固定在第 index 個 host core (超過 core 數時循環)，以 in 為 stdin 執行 shell，
+ * 結束後把統計寫到 result
+ */
+static void compare_child(CompareRun *run, int index, FILE *in, int result)
+{
+    cpu_set_t set;
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    CPU_ZERO(&set);
+    CPU_SET(index % (cores > 0 ? cores : 1), &set);
+    sched_setaffinity(0, sizeof(set), &set);
+
+    dup2(fileno(in), STDIN_FILENO);
+    dup2(fileno(run->log), STDOUT_FILENO);
+    clearerr(stdin); /* parent 已經讀到 EOF */
+    set_policy(run->policy);
+    shell();
+    fflush(stdout);
+
+    TaskStats stats;
+    task_stats(&stats);
+    if (write(result, &stats, sizeof(stats)) != sizeof(stats)) {
+        _exit(1);
+    }
+    _exit(0);
+}
+
+/*
+ * 建立一個演算法的 child process
+ * 回傳值：成功回傳 true
+ */
+static bool compare_spawn(CompareRun *run, int index, const char *input, size_t length)
+{
+    int fds[2];
+    FILE *in = tmpfile();
+    run->log = tmpfile();
+    if (in == NULL || run->log == NULL || pipe(fds) < 0) {
+        perror("compare_all");
+        return false;
+    }
+    fwrite(input, 1, length, in);
+    fflush(in);
+    rewind(in);
+
+    fflush(stdout); /* 避免尚未輸出的內容在 child 中重複 */
+    run->pid = fork();
+    if (run->pid == 0) {
+        close(fds[0]);
+        compare_child(run, index, in, fds[1]);
+    }
+    close(fds[1]);
+    fclose(in);
+    run->result = fds[0];
+    if (run->pid < 0) {
+        perror("compare_all");
+        close(run->result);
+        return false;
+    }
+    return true;
+}
+
+/*
+ * 等待 child 結束並讀取統計
+ */
+static void compare_wait(CompareRun *run)
+{
+    ssize_t n = read(run->result, &run->stats, sizeof(run->stats));
+    run->done = (n == sizeof(run->stats));
+    close(run->result);
+    waitpid(run->pid, NULL, 0);
+}
+
+/*
+ * 依序輸出每個演算法的輸出
+ */
+static void compare_logs(CompareRun *runs, int count)
+{
+    char buf[4096];
+    size_t n;
+    for (int i = 0; i < count; i++) {
+        printf("==================== %s ====================\n", runs[i].policy->name);
+        rewind(runs[i].log);
+        while ((n = fread(buf, 1, sizeof(buf), runs[i].log)) > 0) {
+            fwrite(buf, 1, n, stdout);
+        }
+        printf("\n");
+        fclose(runs[i].log);
+    }
+}
+
+/*
+ * 比較表的一列：每個演算法一欄，child 異常結束時顯示 "-"
+ */
+static void compare_row(CompareRun *runs, int count, const char *name, double (*value)(TaskStats *),
+                        const char *format)
+{
+    char cell[32];
+    printf("%-12s", name);
+    for (int i = 0; i < count; i++) {
+        if (runs[i].done) {
+            snprintf(cell, sizeof(cell), format, value(&runs[i].stats));
+        } else {
+            snprintf(cell, sizeof(cell), "-");
+        }
+        printf("%12s", cell);
+    }
+    printf("\n");
+}
+
+static double row_finished(TaskStats *stats)
+{
+    return stats->finished;
+}
+
+static double row_waiting(TaskStats *stats)
+{
+    return stats->waiting;
+}
+
+static double row_turnaround(TaskStats *stats)
+{
+    return stats->turnaround;
+}
+
+static double row_response(TaskStats *stats)
+{
+    return stats->response;
+}
+
+/*
+ * throughput：每秒 (100 個 tick) 完成的 task 數
+ */
+static double row_throughput(TaskStats *stats)
+{
+    return stats->ticks > 0 ? stats->finished * 100.0 / stats->ticks : 0.0;
+}
+
+static double row_switches(TaskStats *stats)
+{
+    return stats->switches;
+}
+
+static double row_delay_p99(TaskStats *stats)
+{
+    return stats->delay_p99;
+}
+
+static double row_wakeup_p99(TaskStats *stats)
+{
+    return stats->wakeup_p99;
+}
+
+/*
+ * all 模式：以相同的輸入同時執行所有比較的演算法，輸出各自的結果與比較表
+ * (時間單位與 ps 相同，為 10ms)
+ */
+int compare_all()
+{
+    CompareRun runs[NR_ALGORITHMS];
+    int count = 0;
+    size_t length;
+    char *input = read_input(&length);
+
+    for (int i = 0; i < NR_ALGORITHMS; i++) {
+        memset(&runs[count], 0, sizeof(CompareRun));
+        runs[count].policy = policy_find(algorithms[i]);
+        if (runs[count].policy != NULL && compare_spawn(&runs[count], count, input, length)) {
+            count++;
+        }
+    }
+    free(input);
+
+    /* Ctrl+Z 只暫停 child 中的模擬，parent 繼續等待 */
+    signal(SIGTSTP, SIG_IGN);
+    for (int i = 0; i < count; i++) {
+        compare_wait(&runs[i]);
+    }
+    compare_logs(runs, count);
+
+    printf("%-12s", "");
+    for (int i = 0; i < count; i++) {
+        printf("%12s", runs[i].policy->name);
+    }
+    printf("\n");
+    compare_row(runs, count, "finished", row_finished, "%.0f");
+    compare_row(runs, count, "waiting", row_waiting, "%.2f");
+    compare_row(runs, count, "turnaround", row_turnaround, "%.2f");
+    compare_row(runs, count, "response", row_response, "%.2f");
+    compare_row(runs, count, "throughput", row_throughput, "%.2f/s");
+    compare_row(runs, count, "switches", row_switches, "%.0f");
+    compare_row(runs, count, "delay p99", row_delay_p99, "%.0f");
+    compare_row(runs, count, "wakeup p99", row_wakeup_p99, "%.0f");
+    return 0;
+}
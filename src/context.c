@@ -0,0 +1,210 @@
+/**
+ * @file context.c
+ * @brief Task context switch backend 的實作檔
+ *
+ * asm backend 的做法與 setjmp/longjmp 相同：context_asm_save 保存 callee-saved registers、
+ * 返回後的 stack pointer 與返回位址並回傳 0；context_asm_load 還原它們後以回傳值 1
+ * 跳回保存的位置。caller-saved registers 在呼叫時本來就可能被破壞，不需要保存。
+ *
+ * 新的 context 由 context_make 設定：stack pointer 指向 stack 頂端、返回位址為 func，
+ * 並在 stack 上放入 context_asm_trampoline 作為 func 的返回位址，
+ * func 返回時 trampoline 切換到 link (與 ucontext 的 uc_link 相同)。
+ */
+
+#include "../include/context.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+int context_backend = CONTEXT_HAVE_ASM ? CONTEXT_ASM : CONTEXT_UCONTEXT;
+
+#if defined(__x86_64__)
+
+/*
+ * regs 配置：0 rbx、1 rbp、2 r12、3 r13、4 r14、5 r15、6 rsp、7 rip、8 mxcsr / x87 control word
+ */
+__asm__(".text\n"
+        ".globl context_asm_save\n"
+        ".type context_asm_save, @function\n"
+        "context_asm_save:\n"
+        "    movq %rbx, 0(%rdi)\n"
+        "    movq %rbp, 8(%rdi)\n"
+        "    movq %r12, 16(%rdi)\n"
+        "    movq %r13, 24(%rdi)\n"
+        "    movq %r14, 32(%rdi)\n"
+        "    movq %r15, 40(%rdi)\n"
+        "    leaq 8(%rsp), %rdx\n" /* 返回後的 rsp */
+        "    movq %rdx, 48(%rdi)\n"
+        "    movq (%rsp), %rdx\n" /* 返回位址 */
+        "    movq %rdx, 56(%rdi)\n"
+        "    stmxcsr 64(%rdi)\n"
+        "    fnstcw 68(%rdi)\n"
+        "    xorl %eax, %eax\n"
+        "    ret\n"
+        ".size context_asm_save, .-context_asm_save\n"
+        "\n"
+        ".type context_asm_load, @function\n"
+        "context_asm_load:\n"
+        "    movq 0(%rdi), %rbx\n"
+        "    movq 8(%rdi), %rbp\n"
+        "    movq 16(%rdi), %r12\n"
+        "    movq 24(%rdi), %r13\n"
+        "    movq 32(%rdi), %r14\n"
+        "    movq 40(%rdi), %r15\n"
+        "    ldmxcsr 64(%rdi)\n"
+        "    fldcw 68(%rdi)\n"
+        "    movq 48(%rdi), %rsp\n"
+        "    movl $1, %eax\n"
+        "    jmpq *56(%rdi)\n"
+        ".size context_asm_load, .-context_asm_load\n"
+        "\n"
+        ".type context_asm_trampoline, @function\n"
+        "context_asm_trampoline:\n" /* func 返回：r12 為 link */
+        "    movq %r12, %rdi\n"
+        "    jmp context_asm_load\n"
+        ".size context_asm_trampoline, .-context_asm_trampoline\n");
+
+#elif defined(__aarch64__)
+
+/*
+ * regs 配置：0-9 x19-x28、10 x29 (fp)、11 x30 (lr)、12 sp、13 pc、14-21 d8-d15
+ */
+__asm__(".text\n"
+        ".globl context_asm_save\n"
+        ".type context_asm_save, %function\n"
+        "context_asm_save:\n"
+        "    stp x19, x20, [x0, #0]\n"
+        "    stp x21, x22, [x0, #16]\n"
+        "    stp x23, x24, [x0, #32]\n"
+        "    stp x25, x26, [x0, #48]\n"
+        "    stp x27, x28, [x0, #64]\n"
+        "    stp x29, x30, [x0, #80]\n"
+        "    mov x1, sp\n"
+        "    stp x1, x30, [x0, #96]\n" /* sp 與返回位址 */
+        "    stp d8, d9, [x0, #112]\n"
+        "    stp d10, d11, [x0, #128]\n"
+        "    stp d12, d13, [x0, #144]\n"
+        "    stp d14, d15, [x0, #160]\n"
+        "    mov w0, #0\n"
+        "    ret\n"
+        ".size context_asm_save, .-context_asm_save\n"
+        "\n"
+        ".type context_asm_load, %function\n"
+        "context_asm_load:\n"
+        "    ldp x19, x20, [x0, #0]\n"
+        "    ldp x21, x22, [x0, #16]\n"
+        "    ldp x23, x24, [x0, #32]\n"
+        "    ldp x25, x26, [x0, #48]\n"
+        "    ldp x27, x28, [x0, #64]\n"
+        "    ldp x29, x30, [x0, #80]\n"
+        "    ldp d8, d9, [x0, #112]\n"
+        "    ldp d10, d11, [x0, #128]\n"
+        "    ldp d12, d13, [x0, #144]\n"
+        "    ldp d14, d15, [x0, #160]\n"
+        "    ldp x1, x2, [x0, #96]\n"
+        "    mov sp, x1\n"
+        "    mov w0, #1\n"
+        "    br x2\n"
+        ".size context_asm_load, .-context_asm_load\n"
+        "\n"
+        ".type context_asm_trampoline, %function\n"
+        "context_asm_trampoline:\n" /* func 返回：x19 為 link */
+        "    mov x0, x19\n"
+        "    b context_asm_load\n"
+        ".size context_asm_trampoline, .-context_asm_trampoline\n");
+
+#else
+
+/* 不支援 asm backend 的架構：context_backend 固定為 CONTEXT_UCONTEXT，不會被呼叫 */
+int context_asm_save(TaskContext *ctx)
+{
+    abort();
+}
+
+static void context_asm_load(TaskContext *ctx)
+{
+    abort();
+}
+
+#endif
+
+#if CONTEXT_HAVE_ASM
+void context_asm_load(TaskContext *) __attribute__((noreturn));
+void context_asm_trampoline();
+#endif
+
+/*
+ * 設定 backend，必須在建立任何 context 之前呼叫
+ * 不支援 asm backend 的架構一律使用 ucontext
+ */
+void context_set_backend(int backend)
+{
+    context_backend = CONTEXT_HAVE_ASM ? backend : CONTEXT_UCONTEXT;
+}
+
+/*
+ * 取得目前 backend 的名稱
+ */
+const char *context_backend_name()
+{
+    return (context_backend == CONTEXT_ASM) ? "asm" : "ucontext";
+}
+
+/*
+ * 切換到 ctx (同 setcontext)，不會返回
+ */
+void context_load(TaskContext *ctx)
+{
+    if (context_backend == CONTEXT_ASM) {
+        context_asm_load(ctx);
+    }
+    setcontext(&ctx->uc);
+    abort(); /* setcontext 失敗 */
+}
+
+/*
+ * 建立新的 context (同 getcontext + makecontext)
+ *
+ * 參數：
+ *   ctx - 要設定的 context
+ *   stack, size - context 使用的 stack
+ *   func - 進入點
+ *   link - func 返回後切換到的 context
+ */
+void context_make(TaskContext *ctx, char *stack, size_t size, void (*func)(void), TaskContext *link)
+{
+    if (context_backend == CONTEXT_UCONTEXT) {
+        getcontext(&ctx->uc);
+        ctx->uc.uc_stack.ss_sp = stack;
+        ctx->uc.uc_stack.ss_size = size;
+        ctx->uc.uc_link = &link->uc;
+        makecontext(&ctx->uc, func, 0);
+        return;
+    }
+
+    /* stack 頂端對齊 16 bytes */
+    uintptr_t top = ((uintptr_t) (stack + size)) & ~(uintptr_t) 15;
+    for (int i = 0; i < CONTEXT_REGS; i++) {
+        ctx->regs[i] = NULL;
+    }
+#if defined(__x86_64__)
+    /* 進入 func 時 rsp + 8 須對齊 16 bytes，[rsp] 為 func 的返回位址 */
+    top -= 8;
+    *(void **) top = (void *) context_asm_trampoline;
+    ctx->regs[2] = link; /* r12 */
+    ctx->regs[6] = (void *) top;
+    ctx->regs[7] = (void *) func;
+    /* mxcsr 與 x87 control word 沿用目前的設定 */
+    unsigned int mxcsr;
+    unsigned short fpucw;
+    __asm__ volatile("stmxcsr %0" : "=m"(mxcsr));
+    __asm__ volatile("fnstcw %0" : "=m"(fpucw));
+    memcpy((char *) ctx->regs + 64, &mxcsr, sizeof(mxcsr));
+    memcpy((char *) ctx->regs + 68, &fpucw, sizeof(fpucw));
+#elif defined(__aarch64__)
+    ctx->regs[0] = link; /* x19 */
+    ctx->regs[11] = (void *) context_asm_trampoline; /* lr */
+    ctx->regs[12] = (void *) top;
+    ctx->regs[13] = (void *) func;
+#endif
+}
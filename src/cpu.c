@@ -0,0 +1,114 @@
+/**
+ * @file cpu.c
+ * @brief 模擬多 CPU 的實作檔
+ */
+
+#include "../include/cpu.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include "../include/table.h"
+
+static Cpu boot_cpu; /* 未指定 --cpus 時使用的 CPU */
+
+Cpu *cpus = &boot_cpu;
+int nr_cpus = 1;
+__thread int this_cpu = 0;
+
+/*
+ * 建立 n 個 CPU，所有 queue 為空
+ */
+void cpu_init(int n)
+{
+    Cpu *array = (Cpu *) calloc(n, sizeof(Cpu));
+    if (array == NULL) {
+        perror("cpu_init");
+        exit(1);
+    }
+    cpus = array;
+    nr_cpus = n;
+    this_cpu = 0;
+}
+
+/*
+ * 讀取 this_cpu
+ *
+ * M:N 模式下 task 被切換走之後可能在另一個 worker thread 上恢復，而編譯器可以把
+ * thread-local 變數的位址保存在 callee-saved 暫存器中跨越 context switch 重複使用。
+ * task 端的程式碼因此透過這個函數取得 CPU 編號：noipa 禁止 inline 與任何跨函數的分析
+ * (包含 -flto 的 POLICY= build)，呼叫端每次都必須真的呼叫，由函數本身重新計算 TLS 位址；
+ * asm 的 memory barrier 讓不支援 noipa 的編譯器 (以 noinline 代替) 也不會合併多次讀取。
+ */
+#if defined(__GNUC__) && !defined(__clang__)
+__attribute__((noipa))
+#else
+__attribute__((noinline))
+#endif
+int cpu_self()
+{
+    __asm__ volatile("" ::: "memory");
+    return this_cpu;
+}
+
+/*
+ * CPU 的負載：READY task 數，加上正在執行的 task
+ */
+int cpu_load(Cpu *cpu)
+{
+    return cpu->nr_ready + (cpu->current != NULL && TASK_HOT(cpu->current, state) == RUNNING);
+}
+
+/*
+ * 取得負載最高、且有 READY task 可以移走的 CPU
+ * 回傳值：CPU 指標，所有 ready queue 都為空時回傳 NULL
+ */
+Cpu *cpu_busiest()
+{
+    Cpu *busiest = NULL;
+    for (int i = 0; i < nr_cpus; i++) {
+        if (cpus[i].nr_ready > 0 && (busiest == NULL || cpu_load(&cpus[i]) > cpu_load(busiest))) {
+            busiest = &cpus[i];
+        }
+    }
+    return busiest;
+}
+
+/*
+ * 取得負載最低的 CPU，相同負載時取編號小的
+ */
+Cpu *cpu_idlest()
+{
+    Cpu *idlest = &cpus[0];
+    for (int i = 1; i < nr_cpus; i++) {
+        if (cpu_load(&cpus[i]) < cpu_load(idlest)) {
+            idlest = &cpus[i];
+        }
+    }
+    return idlest;
+}
+
+/*
+ * 判斷是否所有 CPU 都沒有工作 (沒有執行中的 task，ready queue 也都為空)
+ */
+bool cpu_all_idle()
+{
+    for (int i = 0; i < nr_cpus; i++) {
+        if (cpu_load(&cpus[i]) > 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * 顯示每個 CPU 的 busy / idle tick 數與使用率
+ */
+void cpu_report()
+{
+    printf("%4s|%8s|%8s|%12s\n", "CPU", "busy", "idle", "utilization");
+    printf("-----------------------------------\n");
+    for (int i = 0; i < nr_cpus; i++) {
+        long total = cpus[i].busy_ticks + cpus[i].idle_ticks;
+        double utilization = (total == 0) ? 0 : 100.0 * cpus[i].busy_ticks / total;
+        printf("%4d|%8ld|%8ld|%11.1f%%\n", i, cpus[i].busy_ticks, cpus[i].idle_ticks, utilization);
+    }
+}
@@ -0,0 +1,105 @@
+/**
+ * @file edf.c
+ * @brief EDF (Earliest Deadline First) 的實作檔
+ *
+ * 絕對 deadline 只在 job release 時改變 (task 不在 ready queue 中)，heap 中的 key 不會變動。
+ */
+
+#include "../include/edf.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * task a 是否排在 task b 之前：絕對 deadline 早的優先，沒有 deadline 的排在最後，相同時依 tid (加入順序)
+ */
+bool edf_before(Task *a, Task *b)
+{
+    if (a->abs_deadline != b->abs_deadline) {
+        if (a->abs_deadline == EDF_NONE || b->abs_deadline == EDF_NONE) {
+            return b->abs_deadline == EDF_NONE;
+        }
+        return a->abs_deadline < b->abs_deadline;
+    }
+    return a->tid < b->tid;
+}
+
+/*
+ * 將 task 放到 heap 的 index i 並更新其 heap_index
+ */
+static void heap_place(EdfQueue *q, int i, Task *task)
+{
+    q->heap[i] = task;
+    task->heap_index = i;
+}
+
+/*
+ * 將 index i 的 task 往上調整 (sift up)
+ */
+static void heap_up(EdfQueue *q, int i)
+{
+    Task *task = q->heap[i];
+    while (i > 0 && edf_before(task, q->heap[(i - 1) / 2])) {
+        heap_place(q, i, q->heap[(i - 1) / 2]);
+        i = (i - 1) / 2;
+    }
+    heap_place(q, i, task);
+}
+
+/*
+ * 將 index i 的 task 往下調整 (sift down)
+ */
+static void heap_down(EdfQueue *q, int i)
+{
+    Task *task = q->heap[i];
+    while (2 * i + 1 < q->size) {
+        int child = 2 * i + 1;
+        if (child + 1 < q->size && edf_before(q->heap[child + 1], q->heap[child])) {
+            child++;
+        }
+        if (!edf_before(q->heap[child], task)) {
+            break;
+        }
+        heap_place(q, i, q->heap[child]);
+        i = child;
+    }
+    heap_place(q, i, task);
+}
+
+/*
+ * 依絕對 deadline 插入 task (O(log n))
+ */
+void edf_insert(EdfQueue *q, Task *task)
+{
+    if (q->size == q->capacity) {
+        q->capacity = (q->capacity == 0) ? 64 : q->capacity * 2;
+        q->heap = (Task **) realloc(q->heap, q->capacity * sizeof(Task *));
+        if (q->heap == NULL) {
+            perror("edf_insert");
+            exit(1);
+        }
+    }
+    q->heap[q->size++] = task;
+    heap_up(q, q->size - 1);
+}
+
+/*
+ * 從 heap 移除 task：以最後一個元素取代被移除的位置，再往上或往下調整 (O(log n))
+ */
+void edf_remove(EdfQueue *q, Task *task)
+{
+    int i = task->heap_index;
+    Task *last = q->heap[--q->size];
+    if (i < q->size) {
+        heap_place(q, i, last);
+        heap_up(q, i);
+        heap_down(q, last->heap_index);
+    }
+}
+
+/*
+ * 取得絕對 deadline 最早的 task，heap 為空時回傳 NULL
+ */
+Task *edf_first(EdfQueue *q)
+{
+    return q->size > 0 ? q->heap[0] : NULL;
+}
@@ -0,0 +1,169 @@
+/**
+ * @file event.c
+ * @brief Scheduler 事件 ring buffer 的實作檔
+ *
+ * producer 只寫入一個 record 並推進 head (handler 中不做格式化)；
+ * drain 以 stdout 的 unlocked stdio 輸出整段文字，不經過 printf 的格式解析。
+ * 文字仍經過同一個 stdout buffer，因此與其他 stdio 輸出 (shell、ps) 的順序和重導向行為與原本相同。
+ */
+
+#define _GNU_SOURCE
+#include "../include/event.h"
+#include <stdio.h>
+#include <time.h>
+#include "../include/cpu.h"
+#include "../include/trace.h"
+
+#define EVENT_MASK (EVENT_RING_SIZE - 1)
+
+static Event ring[EVENT_RING_SIZE];
+static unsigned long ring_head = 0; /* 下一個寫入的位置 (producer) */
+static unsigned long ring_tail = 0; /* 下一個輸出的位置 (consumer) */
+static unsigned long ring_dropped = 0; /* ring 滿時丟棄的事件數 (下一次 drain 時回報) */
+
+/*
+ * 寫入一個事件
+ *
+ * 只記錄在 trace 中的事件 (EV_PREEMPT、EV_WAKE、EVENT_QUIET) 在 trace 關閉時直接忽略。
+ * 可以在 signal handler 中呼叫 (只使用 async-signal-safe 的 clock_gettime)；
+ * ring 滿時不 drain (drain 使用 stdio 與 trace 檔)，丟棄事件並計數
+ */
+void event_push(int type, Task *task, int arg, int cpu, long tick, int flags)
+{
+    if (!trace_enabled && ((flags & EVENT_QUIET) || type == EV_PREEMPT || type == EV_WAKE)) {
+        return;
+    }
+    unsigned long head = ring_head;
+    if (head - __atomic_load_n(&ring_tail, __ATOMIC_ACQUIRE) == EVENT_RING_SIZE) {
+        ring_dropped++;
+        return;
+    }
+    Event *event = &ring[head & EVENT_MASK];
+    event->tick = tick;
+    event->ns = 0;
+    if (trace_enabled) {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        event->ns = ts.tv_sec * 1000000000L + ts.tv_nsec;
+    }
+    event->task = task;
+    event->arg = arg;
+    event->type = type;
+    event->cpu = cpu;
+    event->flags = flags;
+    __atomic_store_n(&ring_head, head + 1, __ATOMIC_RELEASE);
+}
+
+/*
+ * ring 中是否有尚未輸出的事件
+ */
+bool event_pending()
+{
+    return __atomic_load_n(&ring_head, __ATOMIC_ACQUIRE) != ring_tail;
+}
+
+/*
+ * ring 中尚未輸出的事件是否已超過一半 (handler 據此改經過 scheduler 主迴圈 drain，避免丟棄)
+ */
+bool event_crowded()
+{
+    return __atomic_load_n(&ring_head, __ATOMIC_ACQUIRE) - ring_tail >= EVENT_RING_SIZE / 2;
+}
+
+/*
+ * 輸出非負整數 (不使用 printf)
+ */
+static void put_int(int value)
+{
+    char digits[16];
+    int n = 0;
+    do {
+        digits[n++] = '0' + value % 10;
+        value /= 10;
+    } while (value > 0);
+    while (n > 0) {
+        putc_unlocked(digits[--n], stdout);
+    }
+}
+
+/*
+ * 依事件類型輸出與原本 printf 相同的文字
+ */
+static void event_print(const Event *event)
+{
+    if (event->type == EV_IDLE) {
+        fputs_unlocked("CPU idle.\n", stdout);
+        return;
+    }
+    fputs_unlocked("Task ", stdout);
+    fputs_unlocked(event->task->task_name, stdout);
+    switch (event->type) {
+    case EV_DISPATCH:
+        if (nr_cpus > 1) {
+            fputs_unlocked(" is running on CPU ", stdout);
+            put_int(event->cpu);
+            fputs_unlocked(".\n", stdout);
+        } else {
+            fputs_unlocked(" is running.\n", stdout);
+        }
+        break;
+    case EV_SLEEP:
+        fputs_unlocked(" goes to sleep.\n", stdout);
+        break;
+    case EV_WAIT:
+        fputs_unlocked(" is waiting resource.\n", stdout);
+        break;
+    case EV_GRANT:
+        fputs_unlocked(" gets resource ", stdout);
+        put_int(event->arg);
+        putc_unlocked('\n', stdout);
+        break;
+    case EV_RELEASE:
+        fputs_unlocked(" releases resource ", stdout);
+        put_int(event->arg);
+        putc_unlocked('\n', stdout);
+        break;
+    case EV_EXIT:
+        fputs_unlocked(" has terminated.\n", stdout);
+        break;
+    case EV_JOB:
+        fputs_unlocked(" finishes job ", stdout);
+        put_int(event->arg);
+        fputs_unlocked(".\n", stdout);
+        break;
+    }
+}
+
+/*
+ * 依序輸出 ring 中所有的事件 (文字與 trace)
+ *
+ * 在 handler 之外 (scheduler 主迴圈的 critical section 中或模擬停止後) 呼叫；
+ * 事件的 task 在 drain 之前不會被回收。之前 ring 滿時丟棄的事件數在最後回報
+ */
+void event_drain()
+{
+    unsigned long tail = ring_tail;
+    unsigned long head = __atomic_load_n(&ring_head, __ATOMIC_ACQUIRE);
+    if (tail == head && ring_dropped == 0) {
+        return;
+    }
+    flockfile(stdout);
+    for (; tail != head; tail++) {
+        const Event *event = &ring[tail & EVENT_MASK];
+        if (trace_enabled) {
+            trace_write(event);
+        }
+        if (!(event->flags & EVENT_QUIET) && event->type != EV_PREEMPT && event->type != EV_WAKE) {
+            event_print(event);
+        }
+    }
+    if (ring_dropped > 0) {
+        fprintf(stdout, "(%lu scheduler events dropped: event ring full)\n", ring_dropped);
+        ring_dropped = 0;
+    }
+    funlockfile(stdout);
+    __atomic_store_n(&ring_tail, tail, __ATOMIC_RELEASE);
+    if (trace_enabled) {
+        trace_sync();
+    }
+}
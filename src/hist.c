@@ -0,0 +1,129 @@
+/**
+ * @file hist.c
+ * @brief 固定大小的 log-linear (HDR 形式) histogram 實作檔
+ */
+
+#include "../include/hist.h"
+#include <string.h>
+
+#define HIST_LIMIT 0x7fffffffL /* 可以記錄的最大值，更大的值記為此值 */
+
+/*
+ * 值所在的 bucket
+ */
+static int hist_bucket(long value)
+{
+    if (value < 2 * HIST_SUB) {
+        return (int) value;
+    }
+    int shift = 63 - __builtin_clzl(value) - HIST_SUB_BITS; /* magnitude 中 bucket 寬度的 bit 數 */
+    return shift * HIST_SUB + (int) (value >> shift);
+}
+
+/*
+ * bucket 的上界 (bucket 中最大的值)
+ */
+static long hist_upper(int bucket)
+{
+    if (bucket < 2 * HIST_SUB) {
+        return bucket;
+    }
+    int shift = bucket / HIST_SUB - 1;
+    return ((long) (bucket - shift * HIST_SUB) << shift) + (1L << shift) - 1;
+}
+
+/*
+ * 記錄一個值
+ */
+void hist_record(Histogram *hist, long value)
+{
+    if (value < 0) {
+        value = 0;
+    } else if (value > HIST_LIMIT) {
+        value = HIST_LIMIT;
+    }
+    hist->counts[hist_bucket(value)]++;
+    hist->count++;
+    if (value > hist->max) {
+        hist->max = value;
+    }
+}
+
+/*
+ * 把 src 加到 dst
+ */
+void hist_merge(Histogram *dst, const Histogram *src)
+{
+    if (src->count == 0) {
+        return;
+    }
+    for (int i = 0; i < HIST_BUCKETS; i++) {
+        dst->counts[i] += src->counts[i];
+    }
+    dst->count += src->count;
+    if (src->max > dst->max) {
+        dst->max = src->max;
+    }
+}
+
+/*
+ * 第 percent 百分位數：累計數量第一次達到 ceil(percent% * count) 的 bucket 的上界 (不超過 max)
+ */
+long hist_percentile(const Histogram *hist, double percent)
+{
+    if (hist->count == 0) {
+        return 0;
+    }
+    double target = percent / 100 * hist->count;
+    long rank = (long) target;
+    if (rank < target) {
+        rank++; /* ceil (不連結 libm) */
+    }
+    if (rank < 1) {
+        rank = 1;
+    }
+    long seen = 0;
+    for (int i = 0; i < HIST_BUCKETS; i++) {
+        seen += hist->counts[i];
+        if (seen >= rank) {
+            long upper = hist_upper(i);
+            return upper < hist->max ? upper : hist->max;
+        }
+    }
+    return hist->max;
+}
+
+/*
+ * 壓縮：header 之後只保留非 0 的 bucket
+ * 回傳值：寫入的 pair 數 (含 header)
+ */
+int hist_pack(const Histogram *hist, HistPair *out)
+{
+    int n = 1;
+    for (int i = 0; i < HIST_BUCKETS && hist->count > 0; i++) {
+        if (hist->counts[i] > 0) {
+            out[n].bucket = i;
+            out[n].count = hist->counts[i];
+            n++;
+        }
+    }
+    out[0].bucket = n - 1;
+    out[0].count = (unsigned int) hist->max;
+    return n;
+}
+
+/*
+ * 還原 hist_pack 的結果
+ * 回傳值：讀取的 pair 數 (含 header)
+ */
+int hist_unpack(Histogram *hist, const HistPair *in)
+{
+    int n = in[0].bucket;
+    memset(hist, 0, sizeof(Histogram));
+    hist->max = in[0].count;
+    for (int i = 1; i <= n; i++) {
+        hist->counts[in[i].bucket] = in[i].count;
+        hist->count += in[i].count;
+    }
+    return 1 + n;
+}
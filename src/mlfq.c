@@ -0,0 +1,123 @@
+/**
+ * @file mlfq.c
+ * @brief MLFQ (Multi-Level Feedback Queue) 的實作檔
+ *
+ * 每個 level 是一個 TaskList (共用 Task 的 prev/next)，bitmap 記錄非空的 level，
+ * 插入、移除與 pick-next 都是 O(1)。task 所在的 level 記錄在 Task.mlfq_level。
+ */
+
+#include "../include/mlfq.h"
+#include <stdlib.h>
+
+int mlfq_levels = 3;
+int mlfq_quantum[MLFQ_LEVEL_MAX] = {10, 20, 40};
+int mlfq_boost_ms = 500;
+
+/*
+ * 以逗號分隔的時間片設定 level 數與各 level 的時間片，例如 "10,20,40"
+ * 每個時間片必須是 10 的正整數倍 (一個 tick)
+ * 回傳值：格式錯誤或 level 數超過 MLFQ_LEVEL_MAX 時回傳 false (設定不變)
+ */
+bool mlfq_set_quantum(const char *list)
+{
+    int quantum[MLFQ_LEVEL_MAX];
+    int levels = 0;
+    const char *ptr = list;
+
+    while (*ptr != '\0') {
+        char *end;
+        long value = strtol(ptr, &end, 10);
+        if (end == ptr || value <= 0 || value % 10 != 0 || levels == MLFQ_LEVEL_MAX) {
+            return false;
+        }
+        quantum[levels++] = value;
+        if (*end == ',') {
+            end++;
+        } else if (*end != '\0') {
+            return false;
+        }
+        ptr = end;
+    }
+    if (levels == 0) {
+        return false;
+    }
+    for (int i = 0; i < levels; i++) {
+        mlfq_quantum[i] = quantum[i];
+    }
+    mlfq_levels = levels;
+    return true;
+}
+
+/*
+ * 設定 priority boost 的週期 (ms，10 的正整數倍)
+ */
+bool mlfq_set_boost(int ms)
+{
+    if (ms <= 0 || ms % 10 != 0) {
+        return false;
+    }
+    mlfq_boost_ms = ms;
+    return true;
+}
+
+/*
+ * 將 task 放到所在 level 的尾端
+ */
+void mlfq_insert(MlfqQueue *q, Task *task)
+{
+    list_push_back(&q->level[task->mlfq_level], task);
+    q->bitmap |= 1u << task->mlfq_level;
+}
+
+/*
+ * 從 queue 移除 task
+ */
+void mlfq_remove(MlfqQueue *q, Task *task)
+{
+    TaskList *list = &q->level[task->mlfq_level];
+    list_remove(list, task);
+    if (list->count == 0) {
+        q->bitmap &= ~(1u << task->mlfq_level);
+    }
+}
+
+/*
+ * 取得最高 level 的第一個 task，queue 為空時回傳 NULL
+ */
+Task *mlfq_first(MlfqQueue *q)
+{
+    if (q->bitmap == 0) {
+        return NULL;
+    }
+    return q->level[__builtin_ctz(q->bitmap)].head;
+}
+
+/*
+ * 用完整個時間片：降一個 level
+ */
+void mlfq_demote(Task *task)
+{
+    if (task->mlfq_level < mlfq_levels - 1) {
+        task->mlfq_level++;
+    }
+}
+
+/*
+ * Priority boost：把較低 level 的 task 依 level 順序移到 level 0 的尾端
+ * (原本在 level 0 的 task 仍在最前面，同一 level 內保持 FIFO 順序)
+ */
+void mlfq_boost(MlfqQueue *q)
+{
+    for (int i = 1; i < mlfq_levels; i++) {
+        TaskList *list = &q->level[i];
+        while (list->head != NULL) {
+            Task *task = list->head;
+            list_remove(list, task);
+            task->mlfq_level = 0;
+            list_push_back(&q->level[0], task);
+        }
+    }
+    if (q->level[0].count > 0) {
+        q->bitmap = 1u;
+    }
+}
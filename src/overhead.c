@@ -0,0 +1,99 @@
+/**
+ * @file overhead.c
+ * @brief Scheduler overhead 量測的實作檔
+ */
+
+#include "../include/overhead.h"
+#include <stdio.h>
+#include <string.h>
+#include "../include/hist.h"
+
+/*
+ * 累計的量測結果 (時間單位：ns)
+ */
+typedef struct Overhead {
+    long ticks;        /* handler 執行次數 */
+    long handler_ns;   /* handler 的總時間 */
+    Histogram handler; /* 每次 handler 的時間 */
+    long loops;        /* 主迴圈迭代次數 */
+    long schedule_ns;  /* 主迴圈的總時間 */
+    Histogram latency; /* switch latency */
+    long cpu_ns;       /* 模擬期間 process 的 CPU 時間 */
+} Overhead;
+
+static Overhead overhead;
+static long run_cpu_start = -1; /* 模擬開始時的 process CPU 時間 (沒有在模擬中為 -1) */
+
+static long cpu_now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+void overhead_handler(long ns)
+{
+    overhead.ticks++;
+    overhead.handler_ns += ns;
+    hist_record(&overhead.handler, ns);
+}
+
+void overhead_schedule(long ns)
+{
+    overhead.loops++;
+    overhead.schedule_ns += ns;
+}
+
+void overhead_switch(long ns)
+{
+    hist_record(&overhead.latency, ns);
+}
+
+void overhead_run_begin()
+{
+    run_cpu_start = cpu_now();
+}
+
+void overhead_run_end()
+{
+    if (run_cpu_start >= 0) {
+        overhead.cpu_ns += cpu_now() - run_cpu_start;
+        run_cpu_start = -1;
+    }
+}
+
+/*
+ * histogram 的 p50/p90/p99/max (us)
+ */
+static void print_percentiles(const char *name, const Histogram *hist)
+{
+    printf("%-12sp50 %.2f / p90 %.2f / p99 %.2f / max %.2f us\n", name, hist_percentile(hist, 50) / 1000.0,
+           hist_percentile(hist, 90) / 1000.0, hist_percentile(hist, 99) / 1000.0, hist->max / 1000.0);
+}
+
+/*
+ * 顯示量測結果：
+ * - ticks / handler: handler 次數、平均每次的時間與分布
+ * - switches / switch: switch 次數與 latency 的分布
+ * - scheduler: handler 與主迴圈的總時間，overhead 為占 CPU 時間的比例
+ */
+void overhead_print()
+{
+    double scheduler_ms = (overhead.handler_ns + overhead.schedule_ns) / 1e6;
+    double cpu_ms = overhead.cpu_ns / 1e6;
+
+    printf("%-12s%ld (%.2f us/tick)\n", "ticks", overhead.ticks,
+           overhead.ticks > 0 ? overhead.handler_ns / 1000.0 / overhead.ticks : 0.0);
+    print_percentiles("handler", &overhead.handler);
+    printf("%-12s%ld\n", "switches", overhead.latency.count);
+    print_percentiles("switch", &overhead.latency);
+    printf("%-12s%.2f ms (handler %.2f ms, loop %.2f ms in %ld iterations)\n", "scheduler", scheduler_ms,
+           overhead.handler_ns / 1e6, overhead.schedule_ns / 1e6, overhead.loops);
+    printf("%-12s%.2f ms\n", "cpu", cpu_ms);
+    printf("%-12s%.2f%%\n", "overhead", cpu_ms > 0 ? 100 * scheduler_ms / cpu_ms : 0.0);
+}
+
+void overhead_reset()
+{
+    memset(&overhead, 0, sizeof(overhead));
+}
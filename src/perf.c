@@ -0,0 +1,148 @@
+/**
+ * @file perf.c
+ * @brief Host 端硬體 counter (perf_event_open) 的實作檔
+ */
+
+#define _GNU_SOURCE
+#include "../include/perf.h"
+#include <linux/perf_event.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+/* 要開啟的 event (index 為 PERF_*) */
+#define CACHE_READ_MISS ((PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+static const struct {
+    unsigned int type;
+    unsigned long config;
+} perf_events[PERF_EVENTS] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL | CACHE_READ_MISS},
+    {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB | CACHE_READ_MISS},
+};
+
+/* 每個 host thread 各自一組 */
+static __thread bool opened = false;        /* 是否已呼叫過 perf_open */
+static __thread int group_fd = -1;          /* group leader (沒有任何硬體 counter 時為 -1) */
+static __thread int fds[PERF_EVENTS];       /* 每個 event 的 fd (無法開啟的為 -1) */
+static __thread int position[PERF_EVENTS];  /* event 在 group read 結果中的位置 (無法開啟的為 -1) */
+static __thread PerfCounters last;          /* 上一次讀取的值 */
+
+static int supported = 0; /* 曾經開啟成功的 event (bit i 為 PERF_* i) */
+
+/*
+ * 開啟一個 event，group 為 -1 時成為 group leader
+ * 回傳值：fd，失敗時為 -1
+ */
+static int event_open(int event, int group)
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = perf_events[event].type;
+    attr.config = perf_events[event].config;
+    attr.read_format = PERF_FORMAT_GROUP;
+    attr.exclude_kernel = 1; /* perf_event_paranoid >= 2 時一般使用者只能計算 user mode */
+    attr.exclude_hv = 1;
+    return syscall(SYS_perf_event_open, &attr, 0, -1, group, PERF_FLAG_FD_CLOEXEC);
+}
+
+/*
+ * 讀取目前的值：CPU 時間與整個 group 的 counter (一次 read)
+ * read 失敗時 counter 維持上一次的值 (差值為 0)
+ */
+static void perf_read(PerfCounters *out)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    out->ns = ts.tv_sec * 1000000000L + ts.tv_nsec;
+    memcpy(out->count, last.count, sizeof(out->count));
+    if (group_fd < 0) {
+        return;
+    }
+
+    unsigned long values[1 + PERF_EVENTS]; /* PERF_FORMAT_GROUP：event 數之後依開啟順序排列的值 */
+    if (read(group_fd, values, sizeof(values)) <= 0) {
+        return;
+    }
+    for (int i = 0; i < PERF_EVENTS; i++) {
+        if (position[i] >= 0 && position[i] < (long) values[0]) {
+            out->count[i] = values[1 + position[i]];
+        }
+    }
+}
+
+/*
+ * 在目前的 host thread 開啟 counter (已開啟時不做任何事)
+ *
+ * 第一個開啟成功的 event 成為 group leader，其他 event 加入同一個 group
+ * (一起被排到 PMU 上，比例一致)；無法開啟的 event 略過
+ * 回傳值：是否有任何硬體 counter
+ */
+bool perf_open()
+{
+    if (opened) {
+        return group_fd >= 0;
+    }
+    opened = true;
+    int count = 0;
+    for (int i = 0; i < PERF_EVENTS; i++) {
+        fds[i] = event_open(i, group_fd);
+        position[i] = -1;
+        if (fds[i] < 0) {
+            continue;
+        }
+        if (group_fd < 0) {
+            group_fd = fds[i];
+        }
+        position[i] = count++;
+        __atomic_or_fetch(&supported, 1 << i, __ATOMIC_RELAXED);
+    }
+    memset(&last, 0, sizeof(last));
+    perf_read(&last);
+    return group_fd >= 0;
+}
+
+/*
+ * 關閉目前 host thread 的 counter
+ */
+void perf_close()
+{
+    if (!opened) {
+        return;
+    }
+    for (int i = 0; i < PERF_EVENTS; i++) {
+        if (fds[i] >= 0) {
+            close(fds[i]);
+        }
+    }
+    group_fd = -1;
+    opened = false;
+}
+
+/*
+ * 讀取 counter，把上一次讀取之後的差值加到 counters (NULL 表示不計入任何 task)
+ * (只使用 read 與 clock_gettime，可以在 signal handler 中呼叫)
+ */
+void perf_charge(PerfCounters *counters)
+{
+    if (!opened) {
+        return;
+    }
+    PerfCounters now;
+    perf_read(&now);
+    if (counters != NULL) {
+        counters->ns += now.ns - last.ns;
+        for (int i = 0; i < PERF_EVENTS; i++) {
+            counters->count[i] += now.count[i] - last.count[i];
+        }
+    }
+    last = now;
+}
+
+bool perf_supported(int event)
+{
+    return (__atomic_load_n(&supported, __ATOMIC_RELAXED) & (1 << event)) != 0;
+}
@@ -0,0 +1,469 @@
+/**
+ * @file policy.c
+ * @brief 排程演算法 (policy) 的實作檔
+ *
+ * 每個 policy 的 hook 只是把 scheduler 的呼叫轉給對應的 run queue (queue.c、cfs.c、mlfq.c、
+ * sjf.c、edf.c、share.c)；各演算法的時間片、搶佔與 vruntime / pass 的維護都集中在這裡。
+ */
+
+#include "../include/policy.h"
+#include <stdio.h>
+#include <string.h>
+#include "../include/table.h"
+
+int rr_quantum_ms = RR_QUANTUM_MS;
+
+/*
+ * 共用的空 hook
+ */
+static int no_slice(Cpu *cpu, Task *task)
+{
+    return 0;
+}
+
+static void no_dispatch(Cpu *cpu, Task *task)
+{
+}
+
+static void no_tick(Cpu *cpu, Task *task, long ticks)
+{
+}
+
+static void no_block(Task *task, int burst)
+{
+}
+
+static void no_wake(Cpu *cpu, Task *task, bool waking)
+{
+}
+
+static bool no_preempt(Task *task, Task *current)
+{
+    return false;
+}
+
+static void no_migrate(Task *task, Cpu *from, Cpu *to)
+{
+}
+
+static void no_clock(long jiffies)
+{
+}
+
+/*
+ * FCFS / RR：依 tid 排序的 ready queue (bitmap index)
+ */
+static void fifo_enqueue(Cpu *cpu, Task *task)
+{
+    rq_insert(&cpu->ready_queue, task);
+}
+
+static void fifo_dequeue(Cpu *cpu, Task *task)
+{
+    rq_remove(&cpu->ready_queue, task);
+}
+
+static Task *fifo_first(Cpu *cpu)
+{
+    return rq_first(&cpu->ready_queue);
+}
+
+static Task *fifo_after(Cpu *cpu, Task *task)
+{
+    return fifo_first(cpu);
+}
+
+/*
+ * RR：從 task 的下一個開始 (循環，可能是 task 自己)，時間片為 rr_quantum_ms (預設 30ms)
+ */
+static Task *rr_after(Cpu *cpu, Task *task)
+{
+    return rq_next_after(&cpu->ready_queue, task->tid);
+}
+
+static int rr_slice(Cpu *cpu, Task *task)
+{
+    return rr_quantum_ms;
+}
+
+/*
+ * 設定 RR 的時間片 (ms，10 的正整數倍)
+ */
+bool rr_set_quantum(int ms)
+{
+    if (ms <= 0 || ms % 10 != 0) {
+        return false;
+    }
+    rr_quantum_ms = ms;
+    return true;
+}
+
+/*
+ * PP：依 priority 分 level 的 ready queue，相同優先權依 tid
+ */
+static void pp_enqueue(Cpu *cpu, Task *task)
+{
+    pq_insert(&cpu->prio_queue, task);
+}
+
+static void pp_dequeue(Cpu *cpu, Task *task)
+{
+    pq_remove(&cpu->prio_queue, task);
+}
+
+static Task *pp_first(Cpu *cpu)
+{
+    return pq_first(&cpu->prio_queue);
+}
+
+static Task *pp_after(Cpu *cpu, Task *task)
+{
+    return pp_first(cpu);
+}
+
+/*
+ * CFS：依 vruntime 排序的 red-black tree，時間片依權重計算 (task 仍在 tree 中)
+ */
+static void cfs_enqueue(Cpu *cpu, Task *task)
+{
+    cfs_insert(&cpu->cfs_queue, task);
+}
+
+static void cfs_dequeue(Cpu *cpu, Task *task)
+{
+    cfs_remove(&cpu->cfs_queue, task);
+}
+
+static Task *cfs_pick(Cpu *cpu)
+{
+    return cfs_first(&cpu->cfs_queue);
+}
+
+static Task *cfs_after(Cpu *cpu, Task *task)
+{
+    return cfs_pick(cpu);
+}
+
+static int cfs_quantum(Cpu *cpu, Task *task)
+{
+    return cfs_slice(&cpu->cfs_queue, task);
+}
+
+static void cfs_dispatch(Cpu *cpu, Task *task)
+{
+    cfs_update_min(&cpu->cfs_queue, task);
+}
+
+static void cfs_tick(Cpu *cpu, Task *task, long ticks)
+{
+    cfs_charge(task, ticks * TICK_US);
+    cfs_update_min(&cpu->cfs_queue, task);
+}
+
+static void cfs_wake(Cpu *cpu, Task *task, bool waking)
+{
+    cfs_place(&cpu->cfs_queue, task, waking);
+}
+
+/*
+ * vruntime 改以新 CPU 的 min_vruntime 為基準
+ */
+static void cfs_migrate(Task *task, Cpu *from, Cpu *to)
+{
+    task->vruntime += to->cfs_queue.min_vruntime - from->cfs_queue.min_vruntime;
+}
+
+/*
+ * MLFQ：每個 level 一個 FIFO queue；從 RUNNING 回來且時間片已用完的 task 先降一個 level
+ */
+static long boost_epoch = 0; /* 上次 priority boost 的週期編號 (jiffies / boost 週期) */
+
+static void mlfq_enqueue(Cpu *cpu, Task *task)
+{
+    if (TASK_HOT(task, state) == RUNNING && TASK_HOT(task, time_quantum) <= 0) {
+        mlfq_demote(task);
+    }
+    mlfq_insert(&cpu->mlfq_queue, task);
+}
+
+static void mlfq_dequeue(Cpu *cpu, Task *task)
+{
+    mlfq_remove(&cpu->mlfq_queue, task);
+}
+
+static Task *mlfq_pick(Cpu *cpu)
+{
+    return mlfq_first(&cpu->mlfq_queue);
+}
+
+static Task *mlfq_after(Cpu *cpu, Task *task)
+{
+    return mlfq_pick(cpu);
+}
+
+static int mlfq_slice(Cpu *cpu, Task *task)
+{
+    return mlfq_quantum[task->mlfq_level];
+}
+
+/*
+ * priority boost：每 mlfq_boost_ms 把所有 task 移回最高的 level
+ *
+ * tickless / virtual 模式下 jiffies 一次可能前進多個 tick，boost 在推進之後才補做；
+ * level 只在 task 回到 ready queue 與選擇下一個 task 時才有影響，因此結果與準時 boost 相同
+ */
+static void mlfq_clock(long jiffies)
+{
+    long epoch = jiffies / (mlfq_boost_ms / 10);
+    if (epoch == boost_epoch) {
+        return;
+    }
+    boost_epoch = epoch;
+    for (int i = 0; i < nr_cpus; i++) {
+        mlfq_boost(&cpus[i].mlfq_queue);
+    }
+    for (int i = 0; i < task_hot.count; i++) {
+        if (task_hot.task[i] != NULL) {
+            task_hot.task[i]->mlfq_level = 0; /* RUNNING / WAITING 的 task */
+        }
+    }
+}
+
+/*
+ * SJF / SRTF：依預測的剩餘 burst 排序的 min-heap；task 離開 CPU 時結束目前的 CPU burst
+ */
+static void sjf_enqueue(Cpu *cpu, Task *task)
+{
+    sjf_insert(&cpu->sjf_queue, task);
+}
+
+static void sjf_dequeue(Cpu *cpu, Task *task)
+{
+    sjf_remove(&cpu->sjf_queue, task);
+}
+
+static Task *sjf_pick(Cpu *cpu)
+{
+    return sjf_first(&cpu->sjf_queue);
+}
+
+static Task *sjf_after(Cpu *cpu, Task *task)
+{
+    return sjf_pick(cpu);
+}
+
+/*
+ * SRTF 的時間片為預測的剩餘 burst (取 tick 的倍數，至少一個 tick)
+ */
+static int srtf_slice(Cpu *cpu, Task *task)
+{
+    int remaining = (sjf_remaining(task) + 9) / 10 * 10;
+    return remaining > 10 ? remaining : 10;
+}
+
+static bool srtf_preempts(Task *task, Task *current)
+{
+    return sjf_remaining(task) < sjf_remaining(current);
+}
+
+/*
+ * EDF：依絕對 deadline 排序的 min-heap，時間片不會用完 (只在被搶佔時縮短)
+ */
+static void edf_enqueue(Cpu *cpu, Task *task)
+{
+    edf_insert(&cpu->edf_queue, task);
+}
+
+static void edf_dequeue(Cpu *cpu, Task *task)
+{
+    edf_remove(&cpu->edf_queue, task);
+}
+
+static Task *edf_pick(Cpu *cpu)
+{
+    return edf_first(&cpu->edf_queue);
+}
+
+static Task *edf_after(Cpu *cpu, Task *task)
+{
+    return edf_pick(cpu);
+}
+
+static int edf_slice(Cpu *cpu, Task *task)
+{
+    return EDF_SLICE;
+}
+
+/*
+ * Stride / Lottery：時間片為一個 tick
+ */
+static int share_slice(Cpu *cpu, Task *task)
+{
+    return SHARE_QUANTUM;
+}
+
+static void stride_enqueue(Cpu *cpu, Task *task)
+{
+    stride_insert(&cpu->stride_queue, task);
+}
+
+static void stride_dequeue(Cpu *cpu, Task *task)
+{
+    stride_remove(&cpu->stride_queue, task);
+}
+
+static Task *stride_pick(Cpu *cpu)
+{
+    return stride_first(&cpu->stride_queue);
+}
+
+static Task *stride_after(Cpu *cpu, Task *task)
+{
+    return stride_pick(cpu);
+}
+
+static void stride_dispatch(Cpu *cpu, Task *task)
+{
+    stride_update_pass(&cpu->stride_queue, task);
+}
+
+static void stride_tick(Cpu *cpu, Task *task, long ticks)
+{
+    stride_charge(task, ticks);
+}
+
+static void stride_wake(Cpu *cpu, Task *task, bool waking)
+{
+    stride_place(&cpu->stride_queue, task);
+}
+
+/*
+ * pass 改以新 CPU 的 global pass 為基準
+ */
+static void stride_migrate(Task *task, Cpu *from, Cpu *to)
+{
+    task->pass += to->stride_queue.pass - from->stride_queue.pass;
+}
+
+static void lottery_enqueue(Cpu *cpu, Task *task)
+{
+    lottery_insert(&cpu->lottery_queue, task);
+}
+
+static void lottery_dequeue(Cpu *cpu, Task *task)
+{
+    lottery_remove(&cpu->lottery_queue, task);
+}
+
+/*
+ * 每次呼叫重新抽籤
+ */
+static Task *lottery_pick(Cpu *cpu)
+{
+    return lottery_draw(&cpu->lottery_queue);
+}
+
+static Task *lottery_after(Cpu *cpu, Task *task)
+{
+    return lottery_pick(cpu);
+}
+
+const Policy policy_fcfs = {
+    "FCFS", FCFS, 0,
+    fifo_enqueue, fifo_dequeue, fifo_first, fifo_after,
+    no_slice, no_dispatch, no_tick, no_block, no_wake, no_preempt, no_migrate, no_clock,
+};
+
+const Policy policy_rr = {
+    "RR", RR, POLICY_SLICED | POLICY_CIRCULAR,
+    fifo_enqueue, fifo_dequeue, fifo_first, rr_after,
+    rr_slice, no_dispatch, no_tick, no_block, no_wake, no_preempt, no_migrate, no_clock,
+};
+
+const Policy policy_pp = {
+    "PP", PP, 0,
+    pp_enqueue, pp_dequeue, pp_first, pp_after,
+    no_slice, no_dispatch, no_tick, no_block, no_wake, no_preempt, no_migrate, no_clock,
+};
+
+const Policy policy_cfs = {
+    "CFS", CFS, POLICY_SLICED,
+    cfs_enqueue, cfs_dequeue, cfs_pick, cfs_after,
+    cfs_quantum, cfs_dispatch, cfs_tick, no_block, cfs_wake, no_preempt, cfs_migrate, no_clock,
+};
+
+const Policy policy_mlfq = {
+    "MLFQ", MLFQ, POLICY_SLICED,
+    mlfq_enqueue, mlfq_dequeue, mlfq_pick, mlfq_after,
+    mlfq_slice, no_dispatch, no_tick, no_block, no_wake, no_preempt, no_migrate, mlfq_clock,
+};
+
+const Policy policy_sjf = {
+    "SJF", SJF, 0,
+    sjf_enqueue, sjf_dequeue, sjf_pick, sjf_after,
+    no_slice, no_dispatch, no_tick, sjf_burst_end, no_wake, no_preempt, no_migrate, no_clock,
+};
+
+const Policy policy_srtf = {
+    "SRTF", SRTF, POLICY_SLICED | POLICY_PREEMPT,
+    sjf_enqueue, sjf_dequeue, sjf_pick, sjf_after,
+    srtf_slice, no_dispatch, no_tick, sjf_burst_end, no_wake, srtf_preempts, no_migrate, no_clock,
+};
+
+const Policy policy_edf = {
+    "EDF", EDF, POLICY_SLICED | POLICY_PREEMPT,
+    edf_enqueue, edf_dequeue, edf_pick, edf_after,
+    edf_slice, no_dispatch, no_tick, no_block, no_wake, edf_before, no_migrate, no_clock,
+};
+
+const Policy policy_stride = {
+    "STRIDE", STRIDE, POLICY_SLICED,
+    stride_enqueue, stride_dequeue, stride_pick, stride_after,
+    share_slice, stride_dispatch, stride_tick, no_block, stride_wake, no_preempt, stride_migrate, no_clock,
+};
+
+const Policy policy_lottery = {
+    "LOTTERY", LOTTERY, POLICY_SLICED,
+    lottery_enqueue, lottery_dequeue, lottery_pick, lottery_after,
+    share_slice, no_dispatch, no_tick, no_block, no_wake, no_preempt, no_migrate, no_clock,
+};
+
+/*
+ * 建置中包含的 policy (make POLICY=... 時只有一個)
+ */
+static const Policy *policies[] = {
+#ifdef POLICY_ONLY
+    &POLICY_ONLY,
+#else
+    &policy_fcfs, &policy_rr, &policy_pp, &policy_cfs, &policy_mlfq,
+    &policy_sjf, &policy_srtf, &policy_edf, &policy_stride, &policy_lottery,
+#endif
+};
+
+#define NR_POLICIES (int) (sizeof(policies) / sizeof(policies[0]))
+
+/*
+ * 依名稱取得 policy
+ * 回傳值：policy，名稱不存在或建置中不包含時回傳 NULL
+ */
+const Policy *policy_find(const char *name)
+{
+    for (int i = 0; i < NR_POLICIES; i++) {
+        if (strcmp(policies[i]->name, name) == 0) {
+            return policies[i];
+        }
+    }
+    return NULL;
+}
+
+/*
+ * 列出建置中的 policy 名稱 (usage 訊息使用)
+ */
+void policy_names(char *buf, int size)
+{
+    int len = 0;
+    buf[0] = '\0';
+    for (int i = 0; i < NR_POLICIES && len < size; i++) {
+        len += snprintf(buf + len, size - len, "%s%s", i > 0 ? " / " : "", policies[i]->name);
+    }
+}
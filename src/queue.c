@@ -0,0 +1,420 @@
+/**
+ * @file queue.c
+ * @brief Task queue 資料結構的實作檔
+ *
+ * 實作 scheduler 使用的 per-state queue：
+ * - TaskList 的 O(1) enqueue / dequeue / remove
+ * - ReadyQueue 以兩層 bitmap 維持 tid 順序，
+ *   使 scheduler 不需要為了找下一個 READY task 而走訪所有 task
+ * - PrioQueue 以 level bitmap + find-first-set 取得優先權最高的 task
+ */
+
+#include "../include/queue.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BITS_PER_WORD (8 * (int) sizeof(unsigned long)) /* 每個 bitmap word 的 bit 數 */
+
+/*
+ * 將 task 加到 list 尾端
+ */
+void list_push_back(TaskList *list, Task *task)
+{
+    task->prev = list->tail;
+    task->next = NULL;
+    if (list->tail != NULL) {
+        list->tail->next = task;
+    } else {
+        list->head = task; /* list 原本為空 */
+    }
+    list->tail = task;
+    list->count++;
+}
+
+/*
+ * 將 task 加到 list 開頭
+ */
+void list_push_front(TaskList *list, Task *task)
+{
+    task->prev = NULL;
+    task->next = list->head;
+    if (list->head != NULL) {
+        list->head->prev = task;
+    } else {
+        list->tail = task; /* list 原本為空 */
+    }
+    list->head = task;
+    list->count++;
+}
+
+/*
+ * 將 task 插入到 pos 之後
+ */
+void list_insert_after(TaskList *list, Task *pos, Task *task)
+{
+    if (pos == list->tail) {
+        list_push_back(list, task);
+        return;
+    }
+    task->prev = pos;
+    task->next = pos->next;
+    pos->next->prev = task;
+    pos->next = task;
+    list->count++;
+}
+
+/*
+ * 將 task 插入到 pos 之前
+ */
+void list_insert_before(TaskList *list, Task *pos, Task *task)
+{
+    if (pos == list->head) {
+        list_push_front(list, task);
+        return;
+    }
+    task->next = pos;
+    task->prev = pos->prev;
+    pos->prev->next = task;
+    pos->prev = task;
+    list->count++;
+}
+
+/*
+ * 從 list 中移除 task (task 必須在此 list 中)
+ */
+void list_remove(TaskList *list, Task *task)
+{
+    if (task->prev != NULL) {
+        task->prev->next = task->next;
+    } else {
+        list->head = task->next;
+    }
+    if (task->next != NULL) {
+        task->next->prev = task->prev;
+    } else {
+        list->tail = task->prev;
+    }
+    task->prev = NULL;
+    task->next = NULL;
+    list->count--;
+}
+
+/*
+ * 擴充 bitmap，使其可以容納指定的 tid
+ */
+static void rq_grow(ReadyQueue *rq, int tid)
+{
+    int words = rq->words;
+    while (tid >= words * BITS_PER_WORD) {
+        words = (words == 0) ? BITS_PER_WORD : words * 2; /* 每次加倍，讓 summary 也以 word 為單位成長 */
+    }
+    if (words == rq->words) {
+        return;
+    }
+
+    unsigned long *map = (unsigned long *) calloc(words, sizeof(unsigned long));
+    unsigned long *summary = (unsigned long *) calloc(words / BITS_PER_WORD, sizeof(unsigned long));
+    if (map == NULL || summary == NULL) {
+        perror("rq_grow");
+        exit(1);
+    }
+    if (rq->words > 0) {
+        memcpy(map, rq->map, rq->words * sizeof(unsigned long));
+        memcpy(summary, rq->summary, rq->words / BITS_PER_WORD * sizeof(unsigned long));
+    }
+    free(rq->map);
+    free(rq->summary);
+    rq->map = map;
+    rq->summary = summary;
+    rq->words = words;
+}
+
+/*
+ * 設定 / 清除 tid 對應的 bit，同時維護 summary
+ */
+static void rq_set_bit(ReadyQueue *rq, int tid)
+{
+    int w = tid / BITS_PER_WORD;
+    rq->map[w] |= 1UL << (tid % BITS_PER_WORD);
+    rq->summary[w / BITS_PER_WORD] |= 1UL << (w % BITS_PER_WORD);
+}
+
+static void rq_clear_bit(ReadyQueue *rq, int tid)
+{
+    int w = tid / BITS_PER_WORD;
+    rq->map[w] &= ~(1UL << (tid % BITS_PER_WORD));
+    if (rq->map[w] == 0) {
+        rq->summary[w / BITS_PER_WORD] &= ~(1UL << (w % BITS_PER_WORD));
+    }
+}
+
+/*
+ * 找出 queue 中小於 tid 的最大 tid
+ * 回傳值：找到的 tid，若無則回傳 0 (tid 從 1 開始)
+ */
+static int rq_find_prev(ReadyQueue *rq, int tid)
+{
+    int w = tid / BITS_PER_WORD;
+    unsigned long bits = rq->map[w] & ((1UL << (tid % BITS_PER_WORD)) - 1);
+    if (bits != 0) {
+        return w * BITS_PER_WORD + (BITS_PER_WORD - 1 - __builtin_clzl(bits));
+    }
+
+    /* 透過 summary 找前一個非 0 的 map word */
+    int s = w / BITS_PER_WORD;
+    unsigned long sbits = rq->summary[s] & ((1UL << (w % BITS_PER_WORD)) - 1);
+    while (sbits == 0) {
+        if (--s < 0) {
+            return 0;
+        }
+        sbits = rq->summary[s];
+    }
+    w = s * BITS_PER_WORD + (BITS_PER_WORD - 1 - __builtin_clzl(sbits));
+    return w * BITS_PER_WORD + (BITS_PER_WORD - 1 - __builtin_clzl(rq->map[w]));
+}
+
+/*
+ * 找出 queue 中大於 tid 的最小 tid
+ * 回傳值：找到的 tid，若無則回傳 0
+ */
+static int rq_find_next(ReadyQueue *rq, int tid)
+{
+    if (++tid >= rq->words * BITS_PER_WORD) {
+        return 0;
+    }
+    int w = tid / BITS_PER_WORD;
+    unsigned long bits = rq->map[w] & ~((1UL << (tid % BITS_PER_WORD)) - 1);
+    if (bits != 0) {
+        return w * BITS_PER_WORD + __builtin_ctzl(bits);
+    }
+
+    /* 透過 summary 找下一個非 0 的 map word */
+    int s = w / BITS_PER_WORD, summary_words = rq->words / BITS_PER_WORD;
+    unsigned long sbits = (w % BITS_PER_WORD == BITS_PER_WORD - 1)
+                              ? 0
+                              : rq->summary[s] & ~((1UL << (w % BITS_PER_WORD + 1)) - 1);
+    while (sbits == 0) {
+        if (++s >= summary_words) {
+            return 0;
+        }
+        sbits = rq->summary[s];
+    }
+    w = s * BITS_PER_WORD + __builtin_ctzl(sbits);
+    return w * BITS_PER_WORD + __builtin_ctzl(rq->map[w]);
+}
+
+/*
+ * 依 tid 順序將 task 插入 ready queue
+ *
+ * 新加入的 task tid 最大，直接接在尾端；
+ * 從 WAITING 回來的 task 則透過 bitmap 找到前一個 task，插入其後
+ */
+void rq_insert(ReadyQueue *rq, Task *task)
+{
+    rq_grow(rq, task->tid);
+    if (rq->list.tail == NULL || rq->list.tail->tid < task->tid) {
+        list_push_back(&rq->list, task);
+    } else {
+        int prev = rq_find_prev(rq, task->tid);
+        if (prev == 0) {
+            list_push_front(&rq->list, task);
+        } else {
+            list_insert_after(&rq->list, task_lookup(prev), task);
+        }
+    }
+    rq_set_bit(rq, task->tid);
+}
+
+/*
+ * 從 ready queue 移除 task
+ */
+void rq_remove(ReadyQueue *rq, Task *task)
+{
+    rq_clear_bit(rq, task->tid);
+    list_remove(&rq->list, task);
+}
+
+/*
+ * 取得 ready queue 中 tid 最小的 task，若 queue 為空則回傳 NULL
+ */
+Task *rq_first(ReadyQueue *rq)
+{
+    return rq->list.head;
+}
+
+/*
+ * 取得 tid 之後的下一個 READY task (用於 Round Robin)
+ *
+ * 先找 tid 之後的 task，若沒有則從 queue 開頭找 (實現循環)
+ * 回傳值：下一個 task，若 queue 為空則回傳 NULL
+ */
+Task *rq_next_after(ReadyQueue *rq, int tid)
+{
+    int next = rq_find_next(rq, tid);
+    if (next != 0) {
+        return task_lookup(next);
+    }
+    return rq->list.head;
+}
+
+/*
+ * Overflow heap 的比較函數：priority 小的優先，相同 priority 依 tid
+ */
+static bool heap_less(Task *a, Task *b)
+{
+    if (a->priority != b->priority) {
+        return a->priority < b->priority;
+    }
+    return a->tid < b->tid;
+}
+
+/*
+ * 將 task 放到 heap 的 index i 並更新其 heap_index
+ */
+static void heap_place(PrioQueue *pq, int i, Task *task)
+{
+    pq->heap[i] = task;
+    task->heap_index = i;
+}
+
+/*
+ * 將 index i 的 task 往上調整 (sift up)
+ */
+static void heap_up(PrioQueue *pq, int i)
+{
+    Task *task = pq->heap[i];
+    while (i > 0 && heap_less(task, pq->heap[(i - 1) / 2])) {
+        heap_place(pq, i, pq->heap[(i - 1) / 2]);
+        i = (i - 1) / 2;
+    }
+    heap_place(pq, i, task);
+}
+
+/*
+ * 將 index i 的 task 往下調整 (sift down)
+ */
+static void heap_down(PrioQueue *pq, int i)
+{
+    Task *task = pq->heap[i];
+    while (2 * i + 1 < pq->heap_size) {
+        int child = 2 * i + 1;
+        if (child + 1 < pq->heap_size && heap_less(pq->heap[child + 1], pq->heap[child])) {
+            child++;
+        }
+        if (!heap_less(pq->heap[child], task)) {
+            break;
+        }
+        heap_place(pq, i, pq->heap[child]);
+        i = child;
+    }
+    heap_place(pq, i, task);
+}
+
+/*
+ * 設定 / 清除 level 對應的 bit
+ */
+static void pq_set_level(PrioQueue *pq, int level)
+{
+    pq->bitmap[level / BITS_PER_WORD] |= 1UL << (level % BITS_PER_WORD);
+}
+
+static void pq_clear_level(PrioQueue *pq, int level)
+{
+    pq->bitmap[level / BITS_PER_WORD] &= ~(1UL << (level % BITS_PER_WORD));
+}
+
+/*
+ * 將 task 插入 priority queue
+ *
+ * 一般 priority 直接放入對應 level (O(1))；過大的 priority 放入 overflow heap (O(log n))
+ */
+void pq_insert(PrioQueue *pq, Task *task)
+{
+    if (task->priority < PRIO_LEVELS - 1) {
+        rq_insert(&pq->level[task->priority], task);
+        pq_set_level(pq, task->priority);
+        return;
+    }
+
+    /* overflow level：放入 min-heap */
+    if (pq->heap_size == pq->heap_capacity) {
+        pq->heap_capacity = (pq->heap_capacity == 0) ? 64 : pq->heap_capacity * 2;
+        pq->heap = (Task **) realloc(pq->heap, pq->heap_capacity * sizeof(Task *));
+        if (pq->heap == NULL) {
+            perror("pq_insert");
+            exit(1);
+        }
+    }
+    pq->heap[pq->heap_size++] = task;
+    heap_up(pq, pq->heap_size - 1);
+    pq_set_level(pq, PRIO_LEVELS - 1);
+}
+
+/*
+ * 從 priority queue 移除 task
+ */
+void pq_remove(PrioQueue *pq, Task *task)
+{
+    if (task->priority < PRIO_LEVELS - 1) {
+        ReadyQueue *rq = &pq->level[task->priority];
+        rq_remove(rq, task);
+        if (rq->list.head == NULL) {
+            pq_clear_level(pq, task->priority);
+        }
+        return;
+    }
+
+    /* overflow level：以最後一個元素取代被移除的位置，再往上或往下調整 */
+    int i = task->heap_index;
+    Task *last = pq->heap[--pq->heap_size];
+    if (i < pq->heap_size) {
+        heap_place(pq, i, last);
+        heap_up(pq, i);
+        heap_down(pq, last->heap_index);
+    }
+    if (pq->heap_size == 0) {
+        pq_clear_level(pq, PRIO_LEVELS - 1);
+    }
+}
+
+/*
+ * 取得優先權最高的 task (priority 最小，相同則 tid 最小)
+ * 回傳值：task 指標，若 queue 為空則回傳 NULL
+ */
+Task *pq_first(PrioQueue *pq)
+{
+    for (int w = 0; w < PRIO_WORDS; w++) {
+        if (pq->bitmap[w] != 0) {
+            int level = w * BITS_PER_WORD + __builtin_ctzl(pq->bitmap[w]);
+            if (level == PRIO_LEVELS - 1) {
+                return pq->heap[0];
+            }
+            return rq_first(&pq->level[level]);
+        }
+    }
+    return NULL;
+}
+
+/*
+ * 對 priority queue 中的每個 task 呼叫 func (依 level 順序，heap 內不保證順序)
+ */
+void pq_for_each(PrioQueue *pq, void (*func)(Task *))
+{
+    for (int w = 0; w < PRIO_WORDS; w++) {
+        unsigned long bits = pq->bitmap[w];
+        while (bits != 0) {
+            int level = w * BITS_PER_WORD + __builtin_ctzl(bits);
+            bits &= bits - 1;
+            if (level == PRIO_LEVELS - 1) {
+                for (int i = 0; i < pq->heap_size; i++) {
+                    func(pq->heap[i]);
+                }
+            } else {
+                for (Task *ptr = pq->level[level].list.head; ptr != NULL; ptr = ptr->next) {
+                    func(ptr);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,41 @@
+/**
+ * @file reentrant.c
+ * @brief Task 可以安全使用的 libc 函數替代版本的實作檔
+ */
+
+#include "../include/reentrant.h"
+#include <stdbool.h>
+#include <stdlib.h>
+
+static char rand_state[128];         /* 與 glibc rand() 相同大小的狀態 (TYPE_3) */
+static struct random_data rand_data; /* random_r 使用的狀態指標 */
+static bool rand_ready = false;      /* 是否已初始化 */
+
+/*
+ * 同 glibc srand()
+ */
+void task_srand(unsigned seed)
+{
+    if (!rand_ready) {
+        initstate_r(seed, rand_state, sizeof(rand_state), &rand_data);
+        rand_ready = true;
+    } else {
+        srandom_r(seed, &rand_data);
+    }
+}
+
+/*
+ * 同 glibc rand()：未呼叫 task_srand 時與 task_srand(1) 相同
+ *
+ * random_r 不使用 lock；在更新狀態時被切換只會讓兩個 task 得到重複的亂數，
+ * 狀態中的指標永遠在陣列範圍內
+ */
+int task_rand(void)
+{
+    int32_t result;
+    if (!rand_ready) {
+        task_srand(1);
+    }
+    random_r(&rand_data, &result);
+    return result;
+}
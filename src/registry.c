@@ -0,0 +1,189 @@
+/**
+ * @file registry.c
+ * @brief Task 函數 registry 的實作檔
+ *
+ * Open addressing (linear probing) 的 hash table，以 FNV-1a 計算名稱的 hash；
+ * 使用率超過 3/4 時容量加倍。函數只會登錄不會移除，因此不需要 tombstone。
+ */
+
+#define _GNU_SOURCE
+#include "../include/registry.h"
+#include <dlfcn.h>
+#include <link.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/function.h"
+#include "../include/worker.h"
+
+#define REGISTRY_INIT_SIZE 32 /* 初始容量 (2 的次方) */
+
+static TaskFunction *table = NULL; /* slot 的 name 為 NULL 表示空的 */
+static int capacity = 0;
+static int count = 0;
+
+/*
+ * function.c 的內建函數
+ */
+static const TaskFunction builtin_functions[] = {
+    {"task1", task1},
+    {"task2", task2},
+    {"task3", task3},
+    {"task4", task4},
+    {"task5", task5},
+    {"task6", task6},
+    {"task7", task7},
+    {"task8", task8},
+    {"task9", task9},
+    {"test_exit", test_exit},
+    {"test_sleep", test_sleep},
+    {"test_resource1", test_resource1},
+    {"test_resource2", test_resource2},
+    {"idle", idle},
+    {NULL, NULL},
+};
+
+/*
+ * FNV-1a hash
+ */
+static uint32_t hash(const char *name)
+{
+    uint32_t h = 2166136261u;
+    for (; *name != '\0'; name++) {
+        h = (h ^ (unsigned char) *name) * 16777619u;
+    }
+    return h;
+}
+
+/*
+ * 取得名稱所在的 slot，不存在時回傳應該放入的空 slot
+ */
+static TaskFunction *find_slot(TaskFunction *slots, int size, const char *name)
+{
+    uint32_t i = hash(name) & (size - 1);
+    while (slots[i].name != NULL && strcmp(slots[i].name, name) != 0) {
+        i = (i + 1) & (size - 1);
+    }
+    return &slots[i];
+}
+
+/*
+ * 將容量擴充為 size，重新放置所有項目
+ */
+static void rehash(int size)
+{
+    TaskFunction *slots = (TaskFunction *) calloc(size, sizeof(TaskFunction));
+    if (slots == NULL) {
+        perror("registry");
+        exit(1);
+    }
+    for (int i = 0; i < capacity; i++) {
+        if (table[i].name != NULL) {
+            *find_slot(slots, size, table[i].name) = table[i];
+        }
+    }
+    free(table);
+    table = slots;
+    capacity = size;
+}
+
+/*
+ * 登錄 function.c 的內建函數
+ */
+void registry_init()
+{
+    for (const TaskFunction *f = builtin_functions; f->name != NULL; f++) {
+        registry_add(f->name, f->func);
+    }
+}
+
+/*
+ * 登錄函數
+ * 回傳值：成功回傳 true，名稱已存在 (內建函數或先前載入的 plugin) 回傳 false
+ */
+bool registry_add(const char *name, TaskFunc func)
+{
+    if ((count + 1) * 4 > capacity * 3) {
+        rehash(capacity == 0 ? REGISTRY_INIT_SIZE : capacity * 2);
+    }
+    TaskFunction *slot = find_slot(table, capacity, name);
+    if (slot->name != NULL) {
+        return false;
+    }
+    slot->name = strdup(name);
+    slot->func = func;
+    count++;
+    return true;
+}
+
+/*
+ * 依名稱取得 task 的進入點
+ * 回傳值：進入點，找不到回傳 NULL
+ */
+TaskFunc registry_lookup(const char *name)
+{
+    if (capacity == 0) {
+        return NULL;
+    }
+    return find_slot(table, capacity, name)->func;
+}
+
+/*
+ * dl_iterate_phdr 的 callback：找到 base 位址相同的 shared object，
+ * 把它可執行的 segment 加入 M:N 模式的 safe point 範圍 (plugin 的程式碼也可以被切換)
+ */
+static int add_code_range(struct dl_phdr_info *info, size_t size, void *data)
+{
+    if (info->dlpi_addr != *(ElfW(Addr) *) data) {
+        return 0;
+    }
+    for (int i = 0; i < info->dlpi_phnum; i++) {
+        const ElfW(Phdr) *phdr = &info->dlpi_phdr[i];
+        if (phdr->p_type == PT_LOAD && (phdr->p_flags & PF_X)) {
+            char *start = (char *) (info->dlpi_addr + phdr->p_vaddr);
+            worker_code_add(start, start + phdr->p_memsz);
+        }
+    }
+    return 1;
+}
+
+/*
+ * 載入 plugin：dlopen 後登錄它的 task_functions 陣列中的函數
+ *
+ * plugin 中的 task 使用 scheduler 的 API (task_sleep、task_exit、get_resources ...)，
+ * 執行檔以 -rdynamic 連結，讓這些符號可以被 shared object 解析。
+ * 名稱已存在的函數不會覆蓋原本的登錄。
+ *
+ * 回傳值：登錄的函數數量，載入失敗回傳 -1 (錯誤訊息已顯示)
+ */
+int registry_load(const char *path)
+{
+    void *handle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    if (handle == NULL) {
+        printf("load: %s\n", dlerror());
+        return -1;
+    }
+    const TaskFunction *functions = (const TaskFunction *) dlsym(handle, REGISTRY_SYMBOL);
+    if (functions == NULL) {
+        printf("load: %s does not export %s\n", path, REGISTRY_SYMBOL);
+        dlclose(handle);
+        return -1;
+    }
+
+    struct link_map *map;
+    if (dlinfo(handle, RTLD_DI_LINKMAP, &map) == 0) {
+        ElfW(Addr) base = map->l_addr;
+        dl_iterate_phdr(add_code_range, &base);
+    }
+
+    int added = 0;
+    for (const TaskFunction *f = functions; f->name != NULL; f++) {
+        if (registry_add(f->name, f->func)) {
+            added++;
+        } else {
+            printf("load: function %s already exists\n", f->name);
+        }
+    }
+    return added; /* handle 不關閉：task 可能隨時執行其中的程式碼 */
+}
@@ -11,11 +11,14 @@
  * - 資源佔用狀態追蹤
  * - Task 等待與喚醒機制
  * - Context switching 整合
+ *
+ * 資源狀態的檢查與修改都在 scheduler critical section 中進行，
+ * M:N 模式下不同 worker thread 上的 task 不會同時取得同一個資源。
  */
 
 #include "../include/resource.h"
 #include <stdbool.h>
-#include <stdio.h>
+#include "../include/event.h"
 #include "../include/task.h"
 
 /**
@@ -39,7 +42,7 @@ bool all_resource[RESOURCE_SIZE] = {false};
  *
  * 實作細節：
  * 1. 參數驗證：確保 count 在合理範圍內
- * 2. Context 保存：使用 getcontext 保存當前執行狀態
+ * 2. Context 保存：使用 context_save 保存當前執行狀態
  * 3. 可用性檢查：檢查所有資源是否都可用
  * 4. 原子性分配：全部成功或全部失敗
  * 5. 等待處理：若失敗則進入 WAITING 狀態
@@ -55,10 +58,11 @@ void get_resources(int count, int *resources)
 
     /**
      * 保存當前 task 的 context
-     * 若資源不可用，後續會透過 setcontext 跳轉回這裡，
+     * 若資源不可用，後續會透過 context_load 跳轉回這裡，
      * 在資源釋放後重新嘗試分配。
      */
-    getcontext(&(get_current_task()->context));
+    context_save(&(get_current_task()->context));
+    sched_lock();
 
     /* 第一階段：檢查所有要求的資源是否都可用 */
     bool available = true;
@@ -74,19 +78,20 @@ void get_resources(int count, int *resources)
         for (i = 0; i < count; i++) {
             all_resource[resources[i]] = true;                 /* 標記全域資源為佔用 */
             get_current_task()->resource[resources[i]] = true; /* 記錄 task 持有此資源 */
-            printf("Task %s gets resource %d\n", get_current_task()->task_name, resources[i]);
+            task_event(EV_GRANT, resources[i]);
         }
+        sched_unlock();
     } else {
         /* 有資源不可用：task 進入等待狀態 */
-        printf("Task %s is waiting resource.\n", get_current_task()->task_name);
-        get_current_task()->state = WAITING; /* 設定 task 狀態為 WAITING */
+        task_event(EV_WAIT, 0);
+        sched_unlock();
 
         /**
-         * 跳轉到 scheduler 的主迴圈 context
+         * 設定 task 狀態為 WAITING 並跳轉到 scheduler 的主迴圈 context
          * 這會讓 scheduler 選擇下一個可執行的 task，
          * 當前 task 會等待直到資源釋放
          */
-        setcontext(get_current_context());
+        task_wait();
     }
 }
 
@@ -106,7 +111,7 @@ void get_resources(int count, int *resources)
  *
  * 重要特性：
  * - 立即生效：釋放後其他 task 可立即獲得資源
- * - 線程安全：此函數本身不處理 context switching
+ * - 線程安全：在 scheduler critical section 中修改資源狀態，不處理 context switching
  * - 配合 scheduler：釋放後由 scheduler 負責重新調度
  */
 void release_resources(int count, int *resources)
@@ -119,13 +124,15 @@ void release_resources(int count, int *resources)
     }
 
     /* 釋放所有指定的資源 */
+    sched_lock();
     for (i = 0; i < count; i++) {
         all_resource[resources[i]] = false;                 /* 標記全域資源為可用 */
         get_current_task()->resource[resources[i]] = false; /* 清除 task 的資源持有記錄 */
 
-        /* 輸出釋放資訊（用於除錯和監控） */
-        printf("Task %s releases resource %d\n", get_current_task()->task_name, resources[i]);
+        /* 記錄釋放事件（用於除錯和監控，由 scheduler 輸出） */
+        task_event(EV_RELEASE, resources[i]);
     }
+    sched_unlock();
 
     /**
      * 注意：此函數不直接處理 task 的喚醒，
@@ -0,0 +1,241 @@
+/**
+ * @file share.c
+ * @brief Proportional-share (Stride / Lottery) scheduling 的實作檔
+ */
+
+#include "../include/share.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static uint64_t lottery_state = LOTTERY_SEED; /* 抽籤的亂數狀態 (xorshift64*) */
+
+/*
+ * task 的 ticket 數：add 的 priority，0 視為 1 張，超過 STRIDE1 時以 STRIDE1 計算
+ */
+int share_tickets(Task *task)
+{
+    if (task->priority < 1) {
+        return 1;
+    }
+    return task->priority < STRIDE1 ? task->priority : STRIDE1;
+}
+
+/*
+ * Stride：task 執行了 ticks 個 tick
+ */
+void stride_charge(Task *task, long ticks)
+{
+    task->pass += STRIDE1 / share_tickets(task) * ticks;
+}
+
+/*
+ * Stride：加入或被喚醒的 task 從 global pass 開始，不會因為之前沒有執行而累積大量的 CPU 時間
+ */
+void stride_place(StrideQueue *q, Task *task)
+{
+    if (task->pass < q->pass) {
+        task->pass = q->pass;
+    }
+}
+
+/*
+ * Stride：task 被 dispatch，global pass 推進到它的 pass (只增不減)
+ */
+void stride_update_pass(StrideQueue *q, Task *task)
+{
+    if (task->pass > q->pass) {
+        q->pass = task->pass;
+    }
+}
+
+/*
+ * heap 的順序：pass 小的優先，相同時依 tid (加入順序)
+ */
+static bool heap_less(Task *a, Task *b)
+{
+    if (a->pass != b->pass) {
+        return a->pass < b->pass;
+    }
+    return a->tid < b->tid;
+}
+
+/*
+ * 將 task 放到 heap 的 index i 並更新其 heap_index
+ */
+static void heap_place(StrideQueue *q, int i, Task *task)
+{
+    q->heap[i] = task;
+    task->heap_index = i;
+}
+
+/*
+ * 將 index i 的 task 往上調整 (sift up)
+ */
+static void heap_up(StrideQueue *q, int i)
+{
+    Task *task = q->heap[i];
+    while (i > 0 && heap_less(task, q->heap[(i - 1) / 2])) {
+        heap_place(q, i, q->heap[(i - 1) / 2]);
+        i = (i - 1) / 2;
+    }
+    heap_place(q, i, task);
+}
+
+/*
+ * 將 index i 的 task 往下調整 (sift down)
+ */
+static void heap_down(StrideQueue *q, int i)
+{
+    Task *task = q->heap[i];
+    while (2 * i + 1 < q->size) {
+        int child = 2 * i + 1;
+        if (child + 1 < q->size && heap_less(q->heap[child + 1], q->heap[child])) {
+            child++;
+        }
+        if (!heap_less(q->heap[child], task)) {
+            break;
+        }
+        heap_place(q, i, q->heap[child]);
+        i = child;
+    }
+    heap_place(q, i, task);
+}
+
+/*
+ * 依 pass 插入 task (O(log n))
+ */
+void stride_insert(StrideQueue *q, Task *task)
+{
+    if (q->size == q->capacity) {
+        q->capacity = (q->capacity == 0) ? 64 : q->capacity * 2;
+        q->heap = (Task **) realloc(q->heap, q->capacity * sizeof(Task *));
+        if (q->heap == NULL) {
+            perror("stride_insert");
+            exit(1);
+        }
+    }
+    q->heap[q->size++] = task;
+    heap_up(q, q->size - 1);
+}
+
+/*
+ * 從 heap 移除 task：以最後一個元素取代被移除的位置，再往上或往下調整 (O(log n))
+ */
+void stride_remove(StrideQueue *q, Task *task)
+{
+    int i = task->heap_index;
+    Task *last = q->heap[--q->size];
+    if (i < q->size) {
+        heap_place(q, i, last);
+        heap_up(q, i);
+        heap_down(q, last->heap_index);
+    }
+}
+
+/*
+ * 取得 pass 最小的 task，heap 為空時回傳 NULL
+ */
+Task *stride_first(StrideQueue *q)
+{
+    return q->size > 0 ? q->heap[0] : NULL;
+}
+
+/*
+ * Fenwick tree：slot 的 ticket 數增加 delta (O(log n))
+ */
+static void fenwick_add(LotteryQueue *q, int slot, long delta)
+{
+    for (int i = slot + 1; i <= q->capacity; i += i & -i) {
+        q->tree[i] += delta;
+    }
+}
+
+/*
+ * Fenwick tree：找出 prefix sum 大於 target 的第一個 slot (O(log n))
+ * 由最高位開始決定 index 的每個 bit，不需要逐一計算 prefix sum
+ */
+static int fenwick_search(LotteryQueue *q, long target)
+{
+    int index = 0;
+    for (int step = q->capacity; step > 0; step >>= 1) {
+        if (index + step <= q->capacity && q->tree[index + step] <= target) {
+            index += step;
+            target -= q->tree[index];
+        }
+    }
+    return index; /* 1-based 的 index + 1，即 0-based 的 slot */
+}
+
+/*
+ * 將 slot 數量加倍並重建 Fenwick tree
+ */
+static void lottery_grow(LotteryQueue *q)
+{
+    int capacity = (q->capacity == 0) ? 64 : q->capacity * 2;
+    long *tree = (long *) calloc(capacity + 1, sizeof(long));
+    Task **task = (Task **) realloc(q->task, capacity * sizeof(Task *));
+    int *free_slots = (int *) realloc(q->free_slots, capacity * sizeof(int));
+    if (tree == NULL || task == NULL || free_slots == NULL) {
+        perror("lottery_insert");
+        exit(1);
+    }
+    free(q->tree);
+    q->tree = tree;
+    q->task = task;
+    q->free_slots = free_slots;
+    q->capacity = capacity;
+    for (int i = 0; i < q->used; i++) {
+        if (q->task[i] != NULL) {
+            fenwick_add(q, i, share_tickets(q->task[i]));
+        }
+    }
+}
+
+/*
+ * 加入 task 的 ticket (O(log n)，擴充 slot 時為 O(n log n))
+ */
+void lottery_insert(LotteryQueue *q, Task *task)
+{
+    int slot;
+    if (q->free_count > 0) {
+        slot = q->free_slots[--q->free_count];
+    } else {
+        if (q->used == q->capacity) {
+            lottery_grow(q);
+        }
+        slot = q->used++;
+    }
+    q->task[slot] = task;
+    task->heap_index = slot;
+    fenwick_add(q, slot, share_tickets(task));
+    q->total += share_tickets(task);
+}
+
+/*
+ * 移除 task 的 ticket，slot 放回 free list (O(log n))
+ */
+void lottery_remove(LotteryQueue *q, Task *task)
+{
+    int slot = task->heap_index;
+    fenwick_add(q, slot, -share_tickets(task));
+    q->total -= share_tickets(task);
+    q->task[slot] = NULL;
+    q->free_slots[q->free_count++] = slot;
+}
+
+/*
+ * 抽籤：在 [0, total) 中取一個亂數，持有該 ticket 的 task 為下一個要執行的 task
+ * 回傳值：抽中的 task (仍在 queue 中)，queue 為空時回傳 NULL
+ */
+Task *lottery_draw(LotteryQueue *q)
+{
+    if (q->total == 0) {
+        return NULL;
+    }
+    lottery_state ^= lottery_state >> 12;
+    lottery_state ^= lottery_state << 25;
+    lottery_state ^= lottery_state >> 27;
+    uint64_t random = lottery_state * 0x2545F4914F6CDD1DULL;
+    return q->task[fenwick_search(q, (long) (random % (uint64_t) q->total))];
+}
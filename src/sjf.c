@@ -0,0 +1,153 @@
+/**
+ * @file sjf.c
+ * @brief SJF / SRTF (Shortest Job First / Shortest Remaining Time First) 的實作檔
+ *
+ * heap 的 key 在插入時計算並記錄在 Task.burst_key：READY 的 task 不會執行，
+ * 剩餘 burst 在 heap 中不會改變。
+ */
+
+#include "../include/sjf.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include "../include/table.h"
+
+double sjf_alpha = SJF_ALPHA;
+int sjf_initial_ms = SJF_INITIAL_MS;
+
+/*
+ * 設定 alpha：越大越依賴最近一次的 burst，0 表示一直使用初始預測值
+ */
+bool sjf_set_alpha(double alpha)
+{
+    if (alpha < 0 || alpha > 1) {
+        return false;
+    }
+    sjf_alpha = alpha;
+    return true;
+}
+
+/*
+ * 設定第一個 burst 的預測值 (ms)
+ */
+bool sjf_set_initial(int ms)
+{
+    if (ms <= 0) {
+        return false;
+    }
+    sjf_initial_ms = ms;
+    return true;
+}
+
+/*
+ * task 目前 burst 預測的剩餘時間 (ms)：預測值減去這個 burst 已執行的時間，不小於 0
+ */
+int sjf_remaining(Task *task)
+{
+    int remaining = task->burst_predict - (TASK_HOT(task, running) - task->burst_mark) * 10;
+    return remaining > 0 ? remaining : 0;
+}
+
+/*
+ * CPU burst 結束 (task_sleep、等待資源或結束)：記錄實際長度 actual (tick，由 burst_end 量測)
+ * 與這次預測的誤差，以指數平均更新預測值
+ */
+void sjf_burst_end(Task *task, int actual)
+{
+    task->burst_last = actual;
+    task->burst_count++;
+    task->burst_error += labs((long) task->burst_predict - actual * 10);
+    task->burst_predict = (int) (sjf_alpha * actual * 10 + (1 - sjf_alpha) * task->burst_predict + 0.5);
+}
+
+/*
+ * heap 的順序：剩餘 burst 短的優先，相同時依 tid (加入順序)
+ */
+static bool heap_less(Task *a, Task *b)
+{
+    if (a->burst_key != b->burst_key) {
+        return a->burst_key < b->burst_key;
+    }
+    return a->tid < b->tid;
+}
+
+/*
+ * 將 task 放到 heap 的 index i 並更新其 heap_index
+ */
+static void heap_place(SjfQueue *q, int i, Task *task)
+{
+    q->heap[i] = task;
+    task->heap_index = i;
+}
+
+/*
+ * 將 index i 的 task 往上調整 (sift up)
+ */
+static void heap_up(SjfQueue *q, int i)
+{
+    Task *task = q->heap[i];
+    while (i > 0 && heap_less(task, q->heap[(i - 1) / 2])) {
+        heap_place(q, i, q->heap[(i - 1) / 2]);
+        i = (i - 1) / 2;
+    }
+    heap_place(q, i, task);
+}
+
+/*
+ * 將 index i 的 task 往下調整 (sift down)
+ */
+static void heap_down(SjfQueue *q, int i)
+{
+    Task *task = q->heap[i];
+    while (2 * i + 1 < q->size) {
+        int child = 2 * i + 1;
+        if (child + 1 < q->size && heap_less(q->heap[child + 1], q->heap[child])) {
+            child++;
+        }
+        if (!heap_less(q->heap[child], task)) {
+            break;
+        }
+        heap_place(q, i, q->heap[child]);
+        i = child;
+    }
+    heap_place(q, i, task);
+}
+
+/*
+ * 依剩餘 burst 插入 task (O(log n))
+ */
+void sjf_insert(SjfQueue *q, Task *task)
+{
+    if (q->size == q->capacity) {
+        q->capacity = (q->capacity == 0) ? 64 : q->capacity * 2;
+        q->heap = (Task **) realloc(q->heap, q->capacity * sizeof(Task *));
+        if (q->heap == NULL) {
+            perror("sjf_insert");
+            exit(1);
+        }
+    }
+    task->burst_key = sjf_remaining(task);
+    q->heap[q->size++] = task;
+    heap_up(q, q->size - 1);
+}
+
+/*
+ * 從 heap 移除 task：以最後一個元素取代被移除的位置，再往上或往下調整 (O(log n))
+ */
+void sjf_remove(SjfQueue *q, Task *task)
+{
+    int i = task->heap_index;
+    Task *last = q->heap[--q->size];
+    if (i < q->size) {
+        heap_place(q, i, last);
+        heap_up(q, i);
+        heap_down(q, last->heap_index);
+    }
+}
+
+/*
+ * 取得剩餘 burst 最短的 task，heap 為空時回傳 NULL
+ */
+Task *sjf_first(SjfQueue *q)
+{
+    return q->size > 0 ? q->heap[0] : NULL;
+}
@@ -0,0 +1,69 @@
+/**
+ * @file stack.c
+ * @brief Task stack 配置器的實作檔
+ *
+ * 取代原本內嵌在 Task 結構中的 128KB stack：
+ * - 需要時才 mmap，未使用的 page 不佔用實體記憶體
+ * - 每個 stack 下方有 guard page
+ * - 釋放的 stack 保留在 free list，下次 task_create 直接重複使用
+ */
+
+#include "../include/stack.h"
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+static char **free_stacks = NULL; /* 可重複使用的 stack */
+static int free_count = 0;        /* free list 中的 stack 數量 */
+static int free_capacity = 0;     /* free_stacks 陣列容量 */
+
+/*
+ * 取得一個 STACK_SIZE 大小的 stack
+ *
+ * 優先從 free list 取出；否則 mmap 一塊 guard page + STACK_SIZE 的區域，
+ * 並將最低的 page 設為 PROT_NONE
+ *
+ * 回傳值：stack 的起始位址 (guard page 之上)，失敗回傳 NULL
+ */
+char *stack_alloc()
+{
+    if (free_count > 0) {
+        return free_stacks[--free_count];
+    }
+
+    size_t guard = sysconf(_SC_PAGESIZE);
+    char *base = mmap(NULL, guard + STACK_SIZE, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK, -1, 0);
+    if (base == MAP_FAILED) {
+        return NULL;
+    }
+    if (mprotect(base, guard, PROT_NONE) != 0) {
+        munmap(base, guard + STACK_SIZE);
+        return NULL;
+    }
+    return base + guard;
+}
+
+/*
+ * 將 stack 放回 free list
+ *
+ * stack 由高位址往低位址使用，只保留頂端 STACK_WARM_SIZE 的 page 給下一個 task，
+ * 其餘已使用的 page 以 MADV_DONTNEED 歸還給系統
+ */
+void stack_release(char *stack)
+{
+    if (stack == NULL) {
+        return;
+    }
+    if (free_count == free_capacity) {
+        int capacity = (free_capacity == 0) ? 64 : free_capacity * 2;
+        char **stacks = (char **) realloc(free_stacks, capacity * sizeof(char *));
+        if (stacks == NULL) {
+            return; /* 無法記錄，放棄重複使用這個 stack */
+        }
+        free_stacks = stacks;
+        free_capacity = capacity;
+    }
+    madvise(stack, STACK_SIZE - STACK_WARM_SIZE, MADV_DONTNEED);
+    free_stacks[free_count++] = stack;
+}
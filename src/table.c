@@ -0,0 +1,72 @@
+/**
+ * @file table.c
+ * @brief Task hot table 的實作檔
+ */
+
+#include "../include/table.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+TaskHot task_hot; /* 所有 task 的 hot 欄位 */
+
+/*
+ * 將陣列擴充為 capacity 個元素
+ */
+static void *grow(void *array, int capacity, size_t size)
+{
+    void *ptr = realloc(array, capacity * size);
+    if (ptr == NULL) {
+        perror("hot_alloc");
+        exit(1);
+    }
+    return ptr;
+}
+
+/*
+ * 配置一個新的 slot，狀態為 READY、時間統計為 0
+ *
+ * 優先重複使用 free list 中的 slot，沒有時才在尾端新增 (必要時擴充陣列)
+ * 回傳值：slot index
+ */
+int hot_alloc(TaskHot *hot)
+{
+    int slot;
+
+    if (hot->free_count > 0) {
+        slot = hot->free_slots[--hot->free_count];
+    } else {
+        if (hot->count == hot->capacity) {
+            int capacity = (hot->capacity == 0) ? 64 : hot->capacity * 2;
+            hot->state = grow(hot->state, capacity, sizeof(*hot->state));
+            hot->running = grow(hot->running, capacity, sizeof(*hot->running));
+            hot->waiting = grow(hot->waiting, capacity, sizeof(*hot->waiting));
+            hot->turnaround = grow(hot->turnaround, capacity, sizeof(*hot->turnaround));
+            hot->time_quantum = grow(hot->time_quantum, capacity, sizeof(*hot->time_quantum));
+            hot->task = grow(hot->task, capacity, sizeof(*hot->task));
+            hot->free_slots = grow(hot->free_slots, capacity, sizeof(*hot->free_slots));
+            hot->capacity = capacity;
+        }
+        slot = hot->count++;
+    }
+
+    hot->state[slot] = READY;
+    hot->running[slot] = 0;
+    hot->waiting[slot] = 0;
+    hot->turnaround[slot] = 0;
+    hot->time_quantum[slot] = 0;
+    hot->task[slot] = NULL;
+    return slot;
+}
+
+/*
+ * 將 slot 放回 free list
+ *
+ * 狀態設為 TERMINATED，在被重新配置之前不會再被計入任何時間
+ */
+void hot_free(TaskHot *hot, int slot)
+{
+    hot->state[slot] = TERMINATED;
+    hot->task[slot] = NULL;
+    hot->free_slots[hot->free_count++] = slot;
+}
+
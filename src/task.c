@@ -1,534 +1,2425 @@
-#include "../include/task.h"
-#include <signal.h>
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <sys/time.h>
-#include "../include/function.h"
-
-/*
- * Global Variables for Task Management
- */
-static int tid = 1;          /* Task ID 計數器，從 1 開始遞增 */
-static Task *queue = NULL;   /* Task queue 的頭指標 (linked list) */
-static int algorithm = 0;    /* 當前使用的排程演算法 (FCFS/RR/PP) */
-static bool is_idle = false; /* CPU 是否處於 idle 狀態的標記 */
-static bool pause = false;   /* 模擬是否暫停的標記 (Ctrl+Z) */
-
-/* Context 相關變數 */
-static ucontext_t current_context; /* 主迴圈的 context (scheduler context) */
-static ucontext_t pause_context;   /* 暫停時儲存的 context */
-static Task *current_task = NULL;  /* 當前正在執行的 task 指標 */
-
-/*
- * 取得當前執行中的 task
- * 回傳值：當前 task 的指標，若無則回傳 NULL
- */
-Task *get_current_task()
-{
-    return current_task;
-}
-
-/*
- * 取得當前的 scheduler context
- * 用於 task 切換時回到 scheduler 的主迴圈
- */
-ucontext_t *get_current_context()
-{
-    return &current_context;
-}
-
-/*
- * 設定排程演算法
- * 參數：algo - 演算法類型 (FCFS=0, RR=1, PP=2)
- */
-void set_algorithm(int algo)
-{
-    algorithm = algo;
-}
-
-/*
- * 建立新的 task
- *
- * 參數：
- *   task_name - task 的名稱 (唯一識別符)
- *   function_name - 要執行的函數名稱
- *   priority - 優先權 (用於 PP 演算法，數值越小優先權越高)
- *
- * 回傳值：成功回傳 task 指標，失敗回傳 NULL
- */
-Task *task_create(char *task_name, char *function_name, int priority)
-{
-    int i;
-    /* 動態分配 Task Control Block (TCB) 的記憶體 */
-    Task *task = (Task *) malloc(sizeof(Task));
-    if (task == NULL) {
-        return NULL;
-    }
-
-    /* 初始化 task 的基本資訊 */
-    task->task_name = strdup(task_name);         /* 複製 task 名稱 */
-    task->function_name = strdup(function_name); /* 複製函數名稱 */
-    task->priority = priority;                   /* 設定優先權 */
-    task->state = READY;                         /* 初始狀態為 READY */
-    task->tid = tid++;                           /* 分配唯一的 Task ID */
-    task->running = 0;                           /* 執行時間初始化為 0 */
-    task->waiting = 0;                           /* 等待時間初始化為 0 */
-    task->time_quantum = 0;                      /* RR 時間片初始化為 0 */
-    task->turnaround = 0;                        /* Turnaround time 初始化為 0 */
-    task->next = NULL;                           /* linked list 指標初始化 */
-
-    /* 初始化資源陣列，所有資源都未持有 */
-    for (i = 0; i < RESOURCE_SIZE; i++) {
-        task->resource[i] = false;
-    }
-
-    /* 設定 task 的 context (使用 ucontext API) */
-    getcontext(&(task->context));                               /* 取得當前 context 作為基礎 */
-    task->context.uc_stack.ss_sp = task->stack;                 /* 設定 stack 指標 */
-    task->context.uc_stack.ss_size = sizeof(char) * STACK_SIZE; /* 設定 stack 大小 (128KB) */
-    task->context.uc_link = &current_context;                   /* 設定返回的 context (scheduler) */
-    if (strcmp(task->function_name, "task1") == 0) {
-        makecontext(&(task->context), task1, 0);
-    } else if (strcmp(task->function_name, "task2") == 0) {
-        makecontext(&(task->context), task2, 0);
-    } else if (strcmp(task->function_name, "task3") == 0) {
-        makecontext(&(task->context), task3, 0);
-    } else if (strcmp(task->function_name, "task4") == 0) {
-        makecontext(&(task->context), task4, 0);
-    } else if (strcmp(task->function_name, "task5") == 0) {
-        makecontext(&(task->context), task5, 0);
-    } else if (strcmp(task->function_name, "task6") == 0) {
-        makecontext(&(task->context), task6, 0);
-    } else if (strcmp(task->function_name, "task7") == 0) {
-        makecontext(&(task->context), task7, 0);
-    } else if (strcmp(task->function_name, "task8") == 0) {
-        makecontext(&(task->context), task8, 0);
-    } else if (strcmp(task->function_name, "task9") == 0) {
-        makecontext(&(task->context), task9, 0);
-    } else if (strcmp(task->function_name, "test_exit") == 0) {
-        makecontext(&(task->context), test_exit, 0);
-    } else if (strcmp(task->function_name, "test_sleep") == 0) {
-        makecontext(&(task->context), test_sleep, 0);
-    } else if (strcmp(task->function_name, "test_resource1") == 0) {
-        makecontext(&(task->context), test_resource1, 0);
-    } else if (strcmp(task->function_name, "test_resource2") == 0) {
-        makecontext(&(task->context), test_resource2, 0);
-    } else if (strcmp(task->function_name, "idle") == 0) {
-        makecontext(&(task->context), idle, 0);
-    } else {
-        printf("Invalid function name: %s\n", task->function_name);
-        return NULL;
-    }
-    return task;
-}
-
-/*
- * 將 task 加入 task queue
- *
- * 根據不同的排程演算法，task 的插入位置不同：
- * - FCFS/RR: 插入到 queue 尾端 (FIFO)
- * - PP: 根據優先權插入到適當位置 (優先權越小越前面)
- */
-void task_add(Task *task)
-{
-    if (algorithm != PP) { /* FCFS 或 RR 演算法 */
-        /* 將 task 加到 queue 尾端 (FIFO 順序) */
-        if (queue == NULL) {
-            queue = task; /* queue 為空，直接設為第一個 */
-        } else {
-            /* 找到 queue 尾端並插入 */
-            Task *ptr = queue;
-            while (ptr->next != NULL) {
-                ptr = ptr->next;
-            }
-            ptr->next = task;
-        }
-    } else { /* PP 演算法 */
-        /* 根據優先權插入到適當位置 (數值越小優先權越高) */
-        if (queue == NULL) {
-            queue = task; /* queue 為空，直接設為第一個 */
-        } else {
-            /* 檢查是否應該插入到 queue 最前面 */
-            if (task->priority < queue->priority) {
-                task->next = queue;
-                queue = task;
-            } else {
-                /* 找到適當的插入位置 (保持優先權順序) */
-                Task *ptr = queue;
-                while (ptr->next != NULL) {
-                    if (task->priority < ptr->next->priority) {
-                        /* 插入到 ptr 和 ptr->next 之間 */
-                        task->next = ptr->next;
-                        ptr->next = task;
-                        return;
-                    }
-                    ptr = ptr->next;
-                }
-                /* 優先權最低，插入到 queue 尾端 */
-                ptr->next = task;
-            }
-        }
-    }
-}
-
-/*
- * 刪除指定名稱的 task
- *
- * 參數：task_name - 要刪除的 task 名稱
- * 回傳值：成功回傳 true，找不到 task 回傳 false
- *
- * 注意：不是真的從 queue 中移除，而是將狀態設為 TERMINATED
- */
-bool task_del(char *task_name)
-{
-    Task *ptr = queue;
-    /* 遍歷 queue 尋找符合名稱的 task */
-    while (ptr != NULL) {
-        if (strcmp(ptr->task_name, task_name) == 0) {
-            ptr->state = TERMINATED; /* 標記為終止狀態 */
-            return true;
-        }
-        ptr = ptr->next;
-    }
-    return false; /* 找不到指定的 task */
-}
-
-/*
- * 顯示所有 task 的狀態資訊 (類似 Unix ps 命令)
- *
- * 顯示內容包括：
- * - TID: Task ID
- * - name: Task 名稱
- * - state: 當前狀態 (READY/RUNNING/WAITING/TERMINATED)
- * - running: 累計執行時間
- * - waiting: 累計等待時間
- * - turnaround: Turnaround time
- * - resources: 持有的資源列表
- * - priority: 優先權
- */
-void task_ps()
-{
-    printf("%4s|%11s|%11s|%8s|%8s|%11s|%10s|%9s\n", "TID", "name", "state", "running", "waiting", "turnaround",
-           "resources", "priority");
-    printf("--------------------------------------------------------------------------------\n");
-
-    Task *ptr = queue;
-    char *state[4] = {"READY", "RUNNING", "WAITING", "TERMINATED"}; /* 狀態名稱陣列 */
-    char resource[20] = {'\0'};                                     /* 資源列表字串緩衝區 */
-    char turnaround[20] = {'\0'};                                   /* Turnaround time 字串緩衝區 */
-    while (ptr != NULL) {
-        int i = 0;
-        for (i = 0; i < RESOURCE_SIZE; i++) {
-            if (ptr->resource[i] != false) {
-                sprintf(resource + strlen(resource), "%d ", i);
-            }
-            resource[strlen(resource) - 1] = '\0';
-        }
-        if (strlen(resource) == 0) {
-            sprintf(resource, "none");
-        }
-
-        if (ptr->turnaround == 0) {
-            sprintf(turnaround, "none");
-        } else {
-            sprintf(turnaround, "%d", ptr->turnaround);
-        }
-
-        printf("%4d|%11s|%11s|%8d|%8d|%11s|%10s|%9d\n", ptr->tid, ptr->task_name, state[ptr->state], ptr->running,
-               ptr->waiting, turnaround, resource, ptr->priority);
-        ptr = ptr->next;
-    }
-}
-
-/*
- * 設定 timer，每 10ms 觸發一次 SIGVTALRM signal
- *
- * 使用 ITIMER_VIRTUAL：只計算 process 在 user mode 執行的時間
- * 這確保了時間統計的準確性
- */
-void set_timer()
-{
-    struct itimerval value;
-    value.it_value.tv_sec = 0;             /* 初始延遲：0 s */
-    value.it_value.tv_usec = 10 * 1000;    /* 初始延遲：10 ms */
-    value.it_interval.tv_sec = 0;          /* 間隔時間：0 s */
-    value.it_interval.tv_usec = 10 * 1000; /* 間隔時間：10 ms */
-    setitimer(ITIMER_VIRTUAL, &value, NULL);
-}
-
-/*
- * 關閉 timer，停止產生 SIGVTALRM signal
- */
-void close_timer()
-{
-    struct itimerval value;
-    value.it_value.tv_sec = 0; /* 設定為 0 表示停止 timer */
-    value.it_value.tv_usec = 0;
-    value.it_interval.tv_sec = 0;
-    value.it_interval.tv_usec = 0;
-    setitimer(ITIMER_VIRTUAL, &value, NULL);
-}
-
-/*
- * 找出下一個 READY 狀態的 task (用於 Round Robin)
- *
- * 參數：p - 當前 task 的指標
- * 回傳值：下一個 READY 狀態的 task，若無則回傳 NULL
- *
- * 搜尋順序：先從 p 的下一個開始找到 queue 尾端，
- *         再從 queue 頭開始找 (實現循環)
- */
-Task *set_next_ready(Task *p)
-{
-    /* 從當前 task 的下一個開始搜尋到 queue 尾端 */
-    Task *ptr = p->next;
-    while (ptr != NULL) {
-        if (ptr->state == READY) {
-            return ptr;
-        }
-        ptr = ptr->next;
-    }
-    /* 從 queue 頭開始搜尋 (實現循環 Round Robin) */
-    ptr = queue;
-    while (ptr != NULL) {
-        if (ptr->state == READY) {
-            return ptr;
-        }
-        ptr = ptr->next;
-    }
-    return NULL; /* 沒有找到 READY 狀態的 task */
-}
-
-/*
- * SIGVTALRM signal handler
- *
- * 每 10ms 觸發一次，負責：
- * 1. 更新所有 task 的時間統計 (running/waiting/turnaround)
- * 2. 處理 sleep 中的 task (減少 sleep_time)
- * 3. Round Robin 的時間片管理
- * 4. 觸發 context switch (如果需要)
- */
-void signal_handler()
-{
-    Task *ptr = queue, *next_task = NULL;
-    bool running = false; /* 是否有 task 在執行 */
-    bool ready = false;   /* 是否有 task 從 WAITING 變為 READY */
-
-    /* 遍歷所有 task，更新狀態和時間 */
-    while (ptr != NULL) {
-        if (ptr->state == WAITING) {
-            /* 更新 sleep 時間 */
-            if (ptr->sleep_time > 0) {
-                ptr->sleep_time -= 10; /* 每次減少 10ms */
-            }
-            /* Sleep 時間結束，設為 READY 狀態 */
-            if (ptr->sleep_time <= 0) {
-                ptr->state = READY;
-                ready = true;
-            }
-        } else if (ptr->state == RUNNING) {
-            ptr->running++; /* 增加執行時間 */
-            running = true;
-        } else if (ptr->state == READY) {
-            ptr->waiting++; /* 增加等待時間 (在 ready queue 中) */
-        }
-
-        /* Round Robin 時間片管理 */
-        if (algorithm == RR) {
-            if (ptr->state == RUNNING && ptr->time_quantum > 0) {
-                ptr->time_quantum -= 10; /* 減少剩餘時間片 */
-                /* 時間片用完，設為 READY 狀態 */
-                if (ptr->time_quantum <= 0) {
-                    ptr->state = READY;
-                }
-            }
-        }
-
-        /* 更新 turnaround time (除了已終止的 task) */
-        if (ptr->state != TERMINATED) {
-            ptr->turnaround++;
-        }
-        ptr = ptr->next;
-    }
-    /* Round Robin: 檢查當前 task 的時間片是否用完 */
-    if (algorithm == RR && current_task != NULL && current_task->time_quantum <= 0) {
-        next_task = set_next_ready(current_task); /* 找下一個 READY 的 task */
-    }
-
-    /* Round Robin: 執行 context switch */
-    if (next_task != NULL) {
-        getcontext(&(current_task->context)); /* 儲存當前 task 的 context */
-        if (current_task->time_quantum <= 0) {
-            if (current_task != next_task) {
-                printf("Task %s is running.\n", next_task->task_name);
-            }
-            current_task = next_task;
-            next_task->state = RUNNING;
-            next_task->time_quantum = 30;      /* 重設時間片為 30ms (3個 tick) */
-            setcontext(&(next_task->context)); /* 切換到下一個 task */
-        }
-    }
-
-    /* 如果 CPU idle 但有 task 變為 READY，回到 scheduler 主迴圈 */
-    if (is_idle && !running && ready) {
-        setcontext(&current_context);
-    }
-}
-
-/*
- * SIGTSTP (Signal Terminal Stop) signal handler (Ctrl+Z)
- *
- * 處理模擬暫停：
- * 1. 儲存當前 context
- * 2. 關閉 timer
- * 3. 回到 shell 模式
- */
-void pause_handler()
-{
-    pause = true;
-    /* 儲存暫停時的 context，以便之後恢復 */
-    getcontext(&pause_context);
-    if (pause) {
-        close_timer();                /* 停止 timer */
-        setcontext(&current_context); /* 回到 scheduler 主迴圈 */
-    } else {
-        set_timer(); /* 恢復 timer (當從暫停恢復時) */
-    }
-}
-
-/*
- * 開始或恢復 scheduler 執行
- *
- * 這是 scheduler 的主函數，負責：
- * 1. 設定 signal handlers
- * 2. 啟動 timer
- * 3. 執行 scheduling 主迴圈
- * 4. 處理 task 的執行和切換
- */
-void task_start()
-{
-    /* 如果是從暫停狀態恢復，回到暫停時的 context */
-    if (pause) {
-        pause = false;
-        setcontext(&pause_context);
-    }
-
-    /* 註冊 signal handlers */
-    signal(SIGVTALRM, signal_handler); /* Timer signal */
-    signal(SIGTSTP, pause_handler);    /* Ctrl+Z signal */
-
-    set_timer(); /* 啟動 timer */
-
-    /* Scheduler 主迴圈 */
-    while (true) {
-        /* 設定返回點：當呼叫 setcontext(&current_context) 時會跳到這裡 */
-        getcontext(&current_context);
-
-        /* 檢查是否按了 Ctrl+Z */
-        if (pause) {
-            pause = false;
-            break; /* 返回 shell */
-        }
-        /* Round Robin: 處理 task 終止的情況 */
-        if (algorithm == RR && current_task != NULL && current_task->state == TERMINATED) {
-            Task *next_task = set_next_ready(current_task); /* 找下一個 READY 的 task */
-            /* 切換到下一個 task */
-            if (next_task != NULL) {
-                current_task = next_task;
-                next_task->state = RUNNING;
-                next_task->time_quantum = 30; /* 設定時間片 */
-                printf("Task %s is running.\n", next_task->task_name);
-                setcontext(&(next_task->context)); /* 執行 context switch */
-            }
-        }
-        /* 遍歷 task queue，尋找可執行的 task */
-        Task *ptr = queue;
-        is_idle = false;
-        bool all_task_finish = true;
-
-        while (ptr != NULL) {
-            /* 檢查是否還有未完成的 task */
-            if (ptr->state != TERMINATED) {
-                all_task_finish = false;
-            }
-
-            if (ptr->state == READY) {
-                /* 找到 READY 的 task，開始執行 */
-                printf("Task %s is running.\n", ptr->task_name);
-                ptr->state = RUNNING;
-
-                /* Round Robin: 設定時間片 */
-                if (algorithm == RR) {
-                    ptr->time_quantum = 30;
-                }
-
-                current_task = ptr;
-                setcontext(&(ptr->context)); /* 切換到 task context */
-
-            } else if (ptr->state == WAITING) {
-                is_idle = true; /* 有 task 在等待，CPU 可能需要 idle */
-
-            } else if (ptr->state == RUNNING) {
-                /* task 仍在執行中，繼續執行 */
-                current_task = ptr;
-                setcontext(&(ptr->context));
-            }
-            ptr = ptr->next;
-        }
-        /* 所有 task 都已完成，結束模擬 */
-        if (all_task_finish) {
-            printf("Simulation over.\n");
-            close_timer(); /* 關閉 timer */
-            return;
-        }
-
-        /* 沒有可執行的 task，CPU 進入 idle 狀態 */
-        if (is_idle) {
-            printf("CPU idle.\n");
-            idle(); /* 執行 idle 函數 (無窮迴圈) */
-        }
-    }
-}
-
-/*
- * 讓當前 task 進入 sleep 狀態
- *
- * 參數：ms - sleep 的時間 (ms)
- *
- * 執行流程：
- * 1. 將 task 狀態設為 WAITING
- * 2. 設定 sleep_time
- * 3. 儲存當前 context
- * 4. 切換回 scheduler
- */
-void task_sleep(int ms)
-{
-    if (current_task != NULL) {
-        printf("Task %s goes to sleep.\n", current_task->task_name);
-        current_task->state = WAITING;      /* 設為等待狀態 */
-        current_task->sleep_time = 10 * ms; /* 轉換為 10ms 的倍數 */
-
-        /* 儲存當前 context (當 sleep 結束後會從這裡繼續) */
-        getcontext(&(current_task->context));
-
-        if (current_task->state == WAITING) {
-            /* 回到 scheduler 主迴圈 */
-            setcontext(&current_context);
-        }
-    }
-}
-
-/*
- * 結束當前 task
- *
- * 將 task 狀態設為 TERMINATED，並切換回 scheduler
- */
-void task_exit()
-{
-    if (current_task != NULL) {
-        printf("Task %s has terminated.\n", current_task->task_name);
-        current_task->state = TERMINATED; /* 標記為終止狀態 */
-        setcontext(&current_context);     /* 回到 scheduler 主迴圈 */
-    }
-}
+#include "../include/task.h"
+#include <errno.h>
+#include <math.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+#include "../include/archive.h"
+#include "../include/cfs.h"
+#include "../include/cpu.h"
+#include "../include/edf.h"
+#include "../include/event.h"
+#include "../include/function.h"
+#include "../include/mlfq.h"
+#include "../include/overhead.h"
+#include "../include/perf.h"
+#include "../include/policy.h"
+#include "../include/registry.h"
+#include "../include/queue.h"
+#include "../include/share.h"
+#include "../include/sjf.h"
+#include "../include/stack.h"
+#include "../include/table.h"
+#include "../include/virtual.h"
+#include "../include/wheel.h"
+#include "../include/worker.h"
+
+/*
+ * Global Variables for Task Management
+ */
+static int tid = 1;          /* Task ID 計數器，從 1 開始遞增 */
+
+/*
+ * 當前使用的排程演算法 (policy.h)
+ * make POLICY=... 建置時為編譯期常數 (配合 -flto，hook 的呼叫可以被 inline)，set_policy 不會改變它
+ */
+#ifdef POLICY_ONLY
+#define policy (&POLICY_ONLY)
+#else
+static const Policy *policy = &policy_fcfs;
+#endif
+static __thread bool is_idle = false; /* CPU 是否處於 idle 狀態的標記 (每個 host thread 各自一個) */
+static bool pause = false;   /* 模擬是否暫停的標記 (Ctrl+Z) */
+static bool tickless = false; /* 是否使用 tickless 模式 (one-shot timer) */
+static bool virtual_mode = false; /* 是否使用 virtual-time 模式 (不使用 timer，也不執行真正的程式碼) */
+
+/*
+ * Per-state queues
+ *
+ * READY / WAITING 各自一個 queue，RUNNING 的 task 不在任何 queue 中；ready queue 每個 CPU 一個 (cpu.h)。
+ * TERMINATED 的 task 在 scheduler 切換離開後即被回收：TCB、stack 與名稱釋放，
+ * 最終的時間統計移到 task_archive (ps 使用)。
+ * task_table 以 tid 為 index 保存尚未回收的 task (ready queue 的 bitmap 以 tid 找回 task)，
+ * 走訪所有尚未回收的 task 則使用 hot table 的 slot (數量與同時存在的 task 數相同)。
+ */
+static Task **task_table = NULL; /* tid → task 的對照表 (index 0 不使用，已回收的 task 為 NULL) */
+static int task_table_size = 0;  /* task_table 的容量 */
+static TaskList waiting_queue;   /* WAITING queue (sleep 或等待資源) */
+static TaskArchive task_archive; /* 已回收的 TERMINATED task */
+static TimerWheel sleep_wheel;   /* WAITING task 的喚醒 timer (依 wake_tick) */
+static TaskLatency latency_total; /* 所有 task 的延遲 histogram (目前演算法的整體分布) */
+static long jiffies = 0;         /* 模擬開始後經過的 tick 數 */
+
+/*
+ * Tickless 模式
+ *
+ * 不使用週期性的 10ms timer，而是只在下一個事件 (RR 時間片用完、sleep 到期)
+ * 設定 one-shot ITIMER_VIRTUAL。經過的 virtual time 由設定值減去 getitimer 的剩餘值
+ * 累計在 virtual_us，jiffies 由它換算；task 的時間統計改在狀態轉換時依 state_tick 補上。
+ */
+#define TICKLESS_HORIZON 100          /* 沒有事件時 timer 的最長間隔 (tick) */
+static long virtual_us = 0;           /* tickless 模式下累計的 virtual time (us) */
+static long timer_armed_us = 0;       /* 上次同步後 timer 剩餘的時間 (us) */
+
+#define VIRTUAL_HORIZON 100 /* virtual 模式下永不結束的 burst 每次推進的 tick 數 */
+
+/*
+ * Scheduler critical section
+ *
+ * task context、scheduler 主迴圈與 signal handler 都會修改上面的 queue。
+ * 進入 critical section 時設定 sched_locked；此時到達的 SIGVTALRM 只記錄在
+ * tick_pending，待離開 critical section 時再補做，避免 handler 看到修改到一半的 queue。
+ * M:N 模式下另外以 sched_spin 在 worker thread 之間互斥 (handler 中也可以使用的 spin lock)。
+ */
+static __thread volatile sig_atomic_t sched_locked = 0; /* 這個 thread 是否在 critical section 中 */
+static __thread volatile sig_atomic_t tick_pending = 0; /* critical section 期間延後處理的 tick 數 */
+static volatile sig_atomic_t pause_pending = 0; /* critical section 期間被延後的 Ctrl+Z */
+static volatile int sched_spin = 0;             /* M:N 模式的 scheduler lock */
+
+/*
+ * M:N 模式下 worker 停止的原因 (Ctrl+Z 或所有 task 都已完成)
+ */
+#define WORKER_RUN 0
+#define WORKER_PAUSE 1
+#define WORKER_DONE 2
+static volatile sig_atomic_t worker_stop = WORKER_RUN;
+
+/* Context 相關變數 */
+static TaskContext main_context;  /* 主迴圈的 context (scheduler context，M:N 模式下改用 Cpu.context) */
+static TaskContext pause_context; /* 暫停時儲存的 context */
+static Task *handoff = NULL;      /* handler 已 dispatch、由主迴圈在 drain 之後切換過去的 task */
+
+/*
+ * 取得目前 host thread 的 scheduler 主迴圈 context
+ * M:N 模式下每個 worker 有自己的主迴圈，context 放在它執行的 CPU 中
+ */
+static TaskContext *scheduler_context()
+{
+    return nr_workers > 0 ? &cpus[cpu_self()].context : &main_context;
+}
+#define current_context (*scheduler_context())
+
+/* 當前正在執行的 task 指標 (目前由 host thread 執行的 CPU 上的 task) */
+#define current_task (cpus[cpu_self()].current)
+
+void pause_handler();
+
+/*
+ * 取得當前執行中的 task
+ * 回傳值：當前 task 的指標，若無則回傳 NULL
+ */
+Task *get_current_task()
+{
+    return current_task;
+}
+
+/*
+ * 取得當前的 scheduler context
+ * 用於 task 切換時回到 scheduler 的主迴圈
+ */
+TaskContext *get_current_context()
+{
+    return &current_context;
+}
+
+/*
+ * 設定排程演算法
+ * 參數：p - policy_find 取得的 policy (單一 policy 的建置中只會是該 policy)
+ */
+void set_policy(const Policy *p)
+{
+#ifndef POLICY_ONLY
+    policy = p;
+#endif
+}
+
+/*
+ * 設定是否使用 tickless 模式
+ * 參數：enable - true 時改用 one-shot timer，只在下一個事件時觸發 SIGVTALRM
+ */
+void set_tickless(bool enable)
+{
+    tickless = enable;
+}
+
+/*
+ * 設定是否使用 virtual-time 模式
+ * 參數：enable - true 時 task 依 virtual.c 的 script 執行，scheduler 直接推進 virtual clock
+ */
+void set_virtual(bool enable)
+{
+    virtual_mode = enable;
+}
+
+/*
+ * 設定模擬的 CPU 數量
+ * 參數：n - CPU 數量，每個 CPU 有自己的 ready queue 與當前 task
+ */
+void set_cpus(int n)
+{
+    cpu_init(n);
+}
+
+/*
+ * 設定 M:N 模式的 worker thread 數量
+ * 參數：n - worker 數量，每個 worker 執行一個 CPU (見 worker.h)
+ */
+void set_workers(int n)
+{
+    cpu_init(n);
+    nr_workers = n;
+}
+
+/*
+ * 建立新的 task
+ *
+ * 參數：
+ *   task_name - task 的名稱 (唯一識別符)
+ *   function_name - 要執行的函數名稱
+ *   priority - 優先權 (用於 PP 演算法，數值越小優先權越高)
+ *
+ * 回傳值：成功回傳 task 指標，失敗回傳 NULL
+ */
+Task *task_create(char *task_name, char *function_name, int priority)
+{
+    int i;
+    /* 動態分配 Task Control Block (TCB) 的記憶體 */
+    Task *task = (Task *) malloc(sizeof(Task));
+    if (task == NULL) {
+        return NULL;
+    }
+
+    /* 初始化 task 的基本資訊 */
+    task->task_name = strdup(task_name);         /* 複製 task 名稱 */
+    task->function_name = strdup(function_name); /* 複製函數名稱 */
+    task->priority = priority;                   /* 設定優先權 */
+    task->tid = tid++;                           /* 分配唯一的 Task ID */
+    task->cpu = 0;                               /* task_add 時選擇 CPU */
+    task->migrations = 0;                        /* 尚未在 CPU 之間移動過 */
+    task->state_tick = 0;                        /* task_add 時設定 */
+    task->burst_left = 0;                        /* 不在 CPU burst 中 */
+    task->vruntime = 0;                          /* CFS：task_add 時以 min_vruntime 為基準 */
+    task->rb_parent = NULL;                      /* 不在 CFS tree 中 */
+    task->rb_left = NULL;
+    task->rb_right = NULL;
+    task->mlfq_level = 0;                        /* MLFQ：從最高的 level 開始 */
+    task->response = -1;                         /* 尚未執行過 */
+    task->burst_predict = sjf_initial_ms;        /* 第一個 CPU burst 使用初始預測值 */
+    task->burst_last = -1;
+    task->burst_mark = 0;
+    task->burst_key = 0;
+    task->burst_count = 0;
+    task->burst_error = 0;
+    task->deadline = 0;                          /* 沒有 deadline，只執行一次 (task_set_deadline) */
+    task->period = 0;
+    task->job_limit = 0;
+    task->release = 0;                           /* task_add 時設定 */
+    task->abs_deadline = EDF_NONE;
+    task->jobs = 0;
+    task->misses = 0;
+    task->lateness = 0;
+    task->job_response_min = 0;
+    task->job_response_max = 0;
+    task->pass = 0;                              /* Stride：task_add 時以 global pass 為基準 */
+    task->ready_tick = 0;                        /* ready_enqueue 時設定 */
+    task->woken = false;
+    task->latency = NULL;                        /* 建立成功後配置 */
+    memset(&task->counters, 0, sizeof(task->counters));
+    task->next = NULL;                           /* linked list 指標初始化 */
+    task->timer_next = NULL;                     /* 不在 timer wheel 中 */
+    task->timer_pprev = NULL;
+
+    /* 初始化資源陣列，所有資源都未持有 */
+    for (i = 0; i < RESOURCE_SIZE; i++) {
+        task->resource[i] = false;
+    }
+
+    /* 從 stack pool 取得 stack (mmap + guard page，或重複使用已結束 task 的 stack) */
+    task->stack = stack_alloc();
+    if (task->stack == NULL) {
+        free(task->task_name);
+        free(task->function_name);
+        free(task);
+        return NULL;
+    }
+
+    /* 依函數名稱選擇 task 的進入點 (function.c 的內建函數或 load 載入的 plugin，見 registry.h) */
+    void (*func)(void) = NULL;
+    if (virtual_mode && virtual_lookup(task->function_name) != NULL) {
+        func = virtual_task; /* 依 script 執行，不執行真正的程式碼 */
+    } else {
+        func = registry_lookup(task->function_name);
+    }
+    if (func == NULL) {
+        printf("Invalid function name: %s\n", task->function_name);
+        stack_release(task->stack);
+        free(task->task_name);
+        free(task->function_name);
+        free(task);
+        return NULL;
+    }
+
+    /* 設定 task 的 context：使用 task 的 stack，函數返回時回到 scheduler context */
+    task->entry = func;
+    context_make(&(task->context), task->stack, STACK_SIZE, func, &current_context);
+    task->latency = (TaskLatency *) calloc(1, sizeof(TaskLatency));
+    if (task->latency == NULL) {
+        perror("task_create");
+        exit(1);
+    }
+
+    /* 配置 hot table 的 slot：狀態為 READY，時間統計與 RR 時間片為 0 */
+    task->slot = hot_alloc(&task_hot);
+    task_hot.task[task->slot] = task;
+    return task;
+}
+
+/*
+ * Periodic task 的進入點：記錄 job 開始的位置後呼叫 task 函數
+ *
+ * 每個 job 結束時 task_exit 等到下一個 release，再回到 job_context 從這裡重新呼叫函數
+ * (此時 stack 上只剩這個 frame)
+ */
+static void periodic_task()
+{
+    context_save(&(current_task->job_context));
+    current_task->entry();
+    task_exit(); /* 函數直接返回也視為 job 結束 */
+}
+
+/*
+ * 設定 task 的相對 deadline 與 period (在 task_add 之前呼叫)
+ *
+ * 參數：
+ *   deadline - 相對 deadline (單位：10ms)，0 表示與 period 相同
+ *   period - 單位：10ms，0 表示只執行一次；大於 0 時函數每次結束後在下一個 period 重新執行
+ *   jobs - periodic task 執行的 job 數，0 表示直到被 del 為止
+ */
+void task_set_deadline(Task *task, int deadline, int period, int jobs)
+{
+    task->deadline = deadline > 0 ? deadline : period;
+    task->period = period;
+    task->job_limit = jobs;
+    if (period > 0) {
+        context_make(&(task->context), task->stack, STACK_SIZE, periodic_task, &current_context);
+    }
+}
+
+/*
+ * 有 deadline 的 task 的 utilization：每個 job 的 CPU 時間除以 min(deadline, period)
+ *
+ * job 的 CPU 時間以 virtual 模式的 burst profile 估計 (見 virtual.h，可用 burst 命令調整)，
+ * 沒有 profile 的函數 (plugin) 以 0 計算，永不結束的函數為無限大
+ */
+static double utilization(char *function_name, int deadline, int period)
+{
+    VirtualProfile *profile = virtual_lookup(function_name);
+    int window = (period > 0 && period < deadline) ? period : deadline;
+    if (profile == NULL) {
+        return 0;
+    }
+    if (profile->burst == BURST_FOREVER) {
+        return HUGE_VAL;
+    }
+    return (double) profile->burst / window;
+}
+
+/*
+ * EDF 的 admission check：加入 task 後所有有 deadline 的 task 的 utilization 總和不可超過 CPU 數量
+ *
+ * 單一 CPU 時這是 EDF 滿足所有 deadline 的充分條件 (deadline 等於 period 時也是必要條件)；
+ * 多 CPU 時 task 會因 load balancing 移動，只是必要條件
+ *
+ * 參數：function_name / deadline / period 與 task_create、task_set_deadline 相同
+ *       total - 輸出：加入後的 utilization 總和
+ * 回傳值：可以加入時回傳 true (不是 EDF 或沒有 deadline 時總是可以加入)
+ */
+bool task_admit(char *function_name, int deadline, int period, double *total)
+{
+    if (deadline <= 0) {
+        deadline = period;
+    }
+    *total = 0;
+    if (deadline <= 0) {
+        return true;
+    }
+    *total = utilization(function_name, deadline, period);
+    for (int i = 0; i < task_hot.count; i++) {
+        Task *task = task_hot.task[i];
+        if (task != NULL && task->deadline > 0 && TASK_HOT(task, state) != TERMINATED) {
+            *total += utilization(task->function_name, task->deadline, task->period);
+        }
+    }
+    return policy->id != EDF || *total <= nr_cpus;
+}
+
+/*
+ * 依 tid 取得 task
+ * 回傳值：task 指標，若 tid 不存在則回傳 NULL
+ */
+Task *task_lookup(int id)
+{
+    if (id <= 0 || id >= task_table_size) {
+        return NULL;
+    }
+    return task_table[id];
+}
+
+/*
+ * 判斷 task a 在 queue 順序中是否排在 task b 之前
+ *
+ * - FCFS/RR: 依加入順序 (tid)
+ * - PP: 依優先權 (數值越小越前面)，相同優先權依加入順序
+ */
+static bool task_before(Task *a, Task *b)
+{
+    if (policy->id == PP && a->priority != b->priority) {
+        return a->priority < b->priority;
+    }
+    return a->tid < b->tid;
+}
+
+/*
+ * 是否使用時間片：RR 為 rr_quantum_ms (預設 30ms)，CFS 依權重計算 (cfs_slice)，MLFQ 依所在的 level，
+ * SRTF 為預測的剩餘 burst，EDF 不會用完 (SRTF / EDF 被搶佔時縮短為到下一個 tick)，
+ * Stride / Lottery 為一個 tick
+ */
+static inline bool time_sliced()
+{
+    return policy->flags & POLICY_SLICED;
+}
+
+/*
+ * 是否使用 SJF heap 作為 ready queue (ps 顯示 burst 預測)
+ */
+static bool sjf_family()
+{
+    return policy->id == SJF || policy->id == SRTF;
+}
+
+/*
+ * 進入 / 離開 scheduler critical section
+ *
+ * M:N 模式下同時取得 worker 之間的 spin lock (先設定 sched_locked，等待期間到達的 signal 會被延後)。
+ * 離開時若期間有 Ctrl+Z 被延後，補做暫停處理
+ */
+void sched_lock()
+{
+    sched_locked = 1;
+    if (nr_workers > 0) {
+        while (__atomic_test_and_set(&sched_spin, __ATOMIC_ACQUIRE)) {
+            while (__atomic_load_n(&sched_spin, __ATOMIC_RELAXED)) {
+            }
+        }
+    }
+}
+
+static void program_timer();
+
+/*
+ * Scheduler overhead 的量測 (overhead.h)，每個 host thread 各自一組
+ * handler / 主迴圈的時間從開始到離開 critical section (sched_unlock 或 M:N 模式下交給主迴圈)；
+ * switch latency 從 task 離開 CPU 到下一個 task 即將被載入
+ */
+static __thread long handler_start = 0;  /* 執行中的 SIGVTALRM handler 開始的時間 (0 表示沒有) */
+static __thread long schedule_start = 0; /* 主迴圈這次迭代開始的時間 */
+static __thread long switch_start = 0;   /* 上一個 task 離開 CPU 的時間 */
+
+/*
+ * 量測的開始時間；virtual 模式沒有真實的 timer 與 switch，不量測 (主迴圈會執行數百萬次)
+ */
+static inline long overhead_stamp()
+{
+    return virtual_mode ? 0 : overhead_now();
+}
+
+static void overhead_flush()
+{
+    if (handler_start != 0) {
+        overhead_handler(overhead_now() - handler_start);
+        handler_start = 0;
+    }
+    if (schedule_start != 0) {
+        overhead_schedule(overhead_now() - schedule_start);
+        schedule_start = 0;
+    }
+}
+
+/*
+ * 下一個 task 即將被載入：記錄 switch latency (從 task 或 idle 開始執行的不算)
+ */
+static void switch_end()
+{
+    if (switch_start != 0) {
+        overhead_switch(overhead_now() - switch_start);
+        switch_start = 0;
+    }
+}
+
+/*
+ * 硬體 counter (perf.h)：讀取 counter，上一次讀取之後的差值計入 perf_owner，之後的計入 next
+ * (NULL 表示 scheduler 主迴圈或 idle，不計入任何 task)。virtual 模式不執行真正的程式碼，不讀取
+ */
+static __thread Task *perf_owner = NULL; /* 上一次讀取之後在這個 host thread 上執行的 task */
+
+static void counters_switch(Task *next)
+{
+    if (virtual_mode) {
+        return;
+    }
+    perf_charge(perf_owner != NULL ? &perf_owner->counters : NULL);
+    perf_owner = next;
+}
+
+void sched_unlock()
+{
+    overhead_flush();
+    /* tickless：離開 critical section 前依目前狀態重新設定下一個事件 */
+    if (tickless) {
+        program_timer();
+    }
+    if (nr_workers > 0) {
+        __atomic_clear(&sched_spin, __ATOMIC_RELEASE);
+    }
+    sched_locked = 0;
+    if (pause_pending) {
+        pause_pending = 0;
+        pause_handler();
+    }
+}
+
+/*
+ * 從 task 回到 scheduler 主迴圈 (task 進入 WAITING 或 TERMINATED)
+ *
+ * M:N 模式下不在這裡離開 critical section，lock 交給主迴圈釋放：
+ * 切換完成前 task 的 stack 仍在使用中，若先釋放 lock，
+ * 其他 worker 可能已經在另一個 thread 上恢復同一個 task
+ */
+static void switch_to_scheduler()
+{
+    if (nr_workers == 0) {
+        sched_unlock();
+    }
+    context_load(&current_context);
+}
+
+/*
+ * 將 task 在目前狀態經過的時間計入統計，並從 now 開始計算下一個狀態
+ *
+ * 時間統計不在每個 tick 累加，而是在狀態轉換 (以及 ps / summary 讀取) 時依狀態把
+ * state_tick ~ now 的 tick 數一次補上：READY 計入 waiting，RUNNING 計入 running，
+ * 非 TERMINATED 都計入 turnaround。
+ * 時間片與 policy 的 on_tick 在週期性模式下由 scheduler_tick 對執行中的 task 每個 tick 處理，
+ * tickless/virtual 模式下也在這裡一次補上
+ */
+static void account(Task *task, long now)
+{
+    long delta = now - task->state_tick;
+    if (TASK_HOT(task, state) == READY) {
+        TASK_HOT(task, waiting) += delta;
+    } else if (TASK_HOT(task, state) == RUNNING) {
+        TASK_HOT(task, running) += delta;
+        if (tickless || virtual_mode) {
+            if (time_sliced()) {
+                TASK_HOT(task, time_quantum) -= 10 * delta; /* 與每個 tick 減 10 相同 */
+            }
+            policy->on_tick(&cpus[task->cpu], task, delta); /* CFS 的 vruntime、Stride 的 pass */
+        }
+    }
+    if (TASK_HOT(task, state) != TERMINATED) {
+        TASK_HOT(task, turnaround) += delta;
+    }
+    task->state_tick = now;
+}
+
+/*
+ * 記錄 task 的事件 (event.h)，文字由 event_drain 在 handler 之外輸出
+ */
+static void emit(int type, Task *task, int arg, int flags)
+{
+    event_push(type, task, arg, task != NULL ? task->cpu : this_cpu, jiffies, flags);
+}
+
+/*
+ * 記錄當前 task 的事件 (resource.c 使用，需在 critical section 中)
+ */
+void task_event(int type, int arg)
+{
+    emit(type, current_task, arg, 0);
+}
+
+/*
+ * 將 task 設為 READY 並放入所在 CPU 的 ready queue
+ *
+ * - FCFS/RR: 依 tid 插入 (bitmap index，不需走訪 queue)
+ * - PP: 放入對應 priority 的 level，相同優先權依 tid (保持加入順序)
+ * - CFS: 依 vruntime 插入 red-black tree
+ * - MLFQ: 放到所在 level 的尾端；從 RUNNING 回來且時間片已用完的 task 先降一個 level
+ * - SJF/SRTF: 依預測的剩餘 burst 插入 min-heap
+ * - EDF: 依目前 job 的絕對 deadline 插入 min-heap
+ * - Stride: 依 pass 插入 min-heap；Lottery: 把 ticket 數加入 Fenwick tree
+ */
+static void ready_enqueue(Task *task)
+{
+    Cpu *cpu = &cpus[task->cpu];
+    if (TASK_HOT(task, state) == RUNNING) {
+        emit(EV_PREEMPT, task, 0, 0);
+    }
+    task->ready_tick = jiffies;
+    policy->enqueue(cpu, task); /* MLFQ 依放入前的狀態與時間片決定是否降 level */
+    TASK_HOT(task, state) = READY;
+    cpu->nr_ready++;
+}
+
+/*
+ * 將 task 從所在 CPU 的 ready queue 移除
+ */
+static void ready_dequeue(Task *task)
+{
+    Cpu *cpu = &cpus[task->cpu];
+    policy->dequeue(cpu, task);
+    cpu->nr_ready--;
+}
+
+/*
+ * 取得 CPU 上下一個要執行的 READY task
+ * 回傳值：FCFS/RR 為最早加入的 task，PP 為優先權最高的 task，CFS 為 vruntime 最小的 task，
+ *         MLFQ 為最高 level 中最早進入 queue 的 task，SJF/SRTF 為預測剩餘 burst 最短的 task，
+ *         EDF 為絕對 deadline 最早的 task，Stride 為 pass 最小的 task，
+ *         Lottery 為抽籤抽中的 task (每次呼叫重新抽籤)；若無則回傳 NULL
+ */
+static Task *cpu_first(Cpu *cpu)
+{
+    return policy->pick_next(cpu);
+}
+
+/*
+ * 取得目前 CPU 上下一個要執行的 READY task
+ */
+static Task *ready_first()
+{
+    return cpu_first(&cpus[this_cpu]);
+}
+
+
+/*
+ * 時間片用完 (task 已回到 ready queue) 後下一個要執行的 task
+ * RR 從 task 的下一個開始 (循環)，其他演算法取 ready queue 的第一個 task；都可能是 task 自己
+ */
+static Task *slice_next(Task *task)
+{
+    return policy->pick_after(&cpus[this_cpu], task);
+}
+
+/*
+ * 將 READY task 移到另一個 CPU 的 ready queue
+ *
+ * 若 task 是原 CPU 的 current (時間片用完或 sleep 後被喚醒)，原 CPU 不再保留它
+ */
+static void migrate(Task *task, Cpu *to)
+{
+    ready_dequeue(task);
+    if (cpus[task->cpu].current == task) {
+        cpus[task->cpu].current = NULL;
+    }
+    policy->on_migrate(task, &cpus[task->cpu], to); /* CFS 的 vruntime、Stride 的 pass 改以新 CPU 為基準 */
+    long ready_tick = task->ready_tick; /* 移動不影響 scheduling delay */
+    task->cpu = to - cpus;
+    task->migrations++;
+    ready_enqueue(task);
+    task->ready_tick = ready_tick;
+}
+
+/*
+ * Work stealing：CPU 沒有 READY task 時，從負載最高的 CPU 取走下一個要執行的 task
+ * 回傳值：取得的 task (已在 cpu 的 ready queue 中)，沒有可取的 task 時回傳 NULL
+ */
+static Task *steal(Cpu *cpu)
+{
+    Cpu *busiest = cpu_busiest();
+    if (busiest == NULL || busiest == cpu || cpu_load(busiest) < 2) {
+        return NULL; /* 只有一個 task 的 CPU 自己就會執行它 */
+    }
+    Task *task = cpu_first(busiest);
+    migrate(task, cpu);
+    return task;
+}
+
+/*
+ * 讓所有沒有工作的 CPU 嘗試 work stealing
+ */
+static void idle_steal()
+{
+    for (int i = 0; i < nr_cpus; i++) {
+        if (cpu_load(&cpus[i]) == 0) {
+            steal(&cpus[i]);
+        }
+    }
+}
+
+/*
+ * 週期性 load balancing：負載最高與最低的 CPU 相差超過 1 時，移動 READY task 直到平衡
+ */
+static void load_balance()
+{
+    while (true) {
+        Cpu *busiest = cpu_busiest();
+        Cpu *idlest = cpu_idlest();
+        if (busiest == NULL || cpu_load(busiest) - cpu_load(idlest) <= 1) {
+            break;
+        }
+        migrate(cpu_first(busiest), idlest);
+    }
+}
+
+/*
+ * 記錄 task 開始在 CPU 上執行 (多 CPU 時訊息加上 CPU 編號)；
+ * 同一個 task 重新 dispatch 時 quiet 為 true，只記錄在 trace 中
+ */
+static void print_running(Task *task, bool quiet)
+{
+    emit(EV_DISPATCH, task, 0, quiet ? EVENT_QUIET : 0);
+}
+
+/*
+ * 將 task 從 ready queue 取出，設為 RUNNING 並成為當前 task
+ * Round Robin 會重設時間片為 rr_quantum_ms (預設 30ms，3 個 tick)，CFS 依權重計算時間片，MLFQ 使用所在 level 的時間片，
+ * SRTF 的時間片為預測的剩餘 burst (取 tick 的倍數，至少一個 tick)，EDF 的時間片不會用完，
+ * Stride / Lottery 為一個 tick；
+ * 第一次執行時記錄 response time (到目前為止都在 READY，即累計的 waiting)；
+ * 每次都把進入 READY 後經過的時間記錄到 scheduling delay (喚醒後的第一次同時記錄到 wakeup latency)
+ */
+static void dispatch(Task *task)
+{
+    Cpu *cpu = &cpus[task->cpu];
+    account(task, jiffies);
+    if (cpu->current != task) {
+        cpu->switches++;
+    }
+    long delay = jiffies - task->ready_tick;
+    hist_record(&task->latency->delay, delay);
+    hist_record(&latency_total.delay, delay);
+    if (task->woken) {
+        hist_record(&task->latency->wakeup, delay);
+        hist_record(&latency_total.wakeup, delay);
+        task->woken = false;
+    }
+    if (time_sliced()) {
+        TASK_HOT(task, time_quantum) = policy->slice(cpu, task); /* task 仍在 queue 中 (CFS 依 load 計算) */
+    }
+    if (task->response < 0) {
+        task->response = TASK_HOT(task, waiting);
+    }
+    ready_dequeue(task);
+    TASK_HOT(task, state) = RUNNING;
+    policy->on_dispatch(cpu, task);
+    current_task = task;
+}
+
+/*
+ * CPU burst 結束 (sleep、等待資源、job 完成或結束)：記錄這個 burst 累計的 running，
+ * 下一個 burst 從目前的 running 開始，再以量到的長度呼叫 policy 的 on_block
+ */
+static void burst_end(Task *task)
+{
+    int burst = TASK_HOT(task, running) - task->burst_mark;
+    hist_record(&task->latency->burst, burst);
+    hist_record(&latency_total.burst, burst);
+    task->burst_mark = TASK_HOT(task, running);
+    policy->on_block(task, burst);
+}
+
+/*
+ * 回收 TERMINATED task
+ *
+ * 最終的時間統計記錄到 archive，之後釋放 hot table slot、stack、名稱與 TCB。
+ * 當前 task 的 stack 可能仍在使用中 (task_exit 尚未切換回 scheduler，
+ * 或暫停時的 context 在它的 stack 上)，由 scheduler 主迴圈切換離開後再回收
+ */
+static void task_reap(Task *task)
+{
+    archive_add(&task_archive, task);
+    task_table[task->tid] = NULL;
+    hot_free(&task_hot, task->slot);
+    if (task->stack != NULL) {
+        stack_release(task->stack);
+    }
+    free(task->latency);
+    free(task->task_name);
+    free(task->function_name);
+    free(task);
+}
+
+/*
+ * SRTF / EDF：task 變為 READY 時，若它比所在 CPU 上執行中的 task 優先
+ * (SRTF 為預測的剩餘 burst 較短，EDF 為絕對 deadline 較早)，
+ * 讓執行中的 task 的時間片在下一個 tick 結束，之後經由與 RR 時間片用完相同的路徑切換
+ * (M:N 模式下執行中的 task 可能在另一個 worker 上，不能在這裡直接放回 ready queue)
+ */
+static void wakeup_preempt(Task *task)
+{
+    Task *current = cpus[task->cpu].current;
+    if (!(policy->flags & POLICY_PREEMPT) || current == NULL || current == task ||
+        TASK_HOT(current, state) != RUNNING) {
+        return;
+    }
+    account(current, jiffies); /* tickless / virtual：先補上 running 與時間片 */
+    if (policy->preempts(task, current) && TASK_HOT(current, time_quantum) > 10) {
+        TASK_HOT(current, time_quantum) = 10;
+    }
+}
+
+/*
+ * 將 task 加入系統
+ *
+ * 記錄到 task_table 並放入 ready queue，插入位置依排程演算法而定：
+ * - FCFS/RR: 插入到 ready queue 尾端 (FIFO)
+ * - PP: 根據優先權插入到適當位置 (優先權越小越前面)
+ */
+void task_add(Task *task)
+{
+    /* 擴充 task_table 使其可以容納新的 tid */
+    if (task->tid >= task_table_size) {
+        int size = (task_table_size == 0) ? 64 : task_table_size;
+        while (size <= task->tid) {
+            size *= 2;
+        }
+        Task **table = (Task **) realloc(task_table, size * sizeof(Task *));
+        if (table == NULL) {
+            perror("task_add");
+            exit(1);
+        }
+        memset(table + task_table_size, 0, (size - task_table_size) * sizeof(Task *));
+        task_table = table;
+        task_table_size = size;
+    }
+    task_table[task->tid] = task;
+
+    task->state_tick = jiffies;
+    task->release = jiffies; /* 第一個 job 在加入時 release */
+    if (task->deadline > 0) {
+        task->abs_deadline = jiffies + task->deadline;
+    }
+    task->cpu = cpu_idlest() - cpus; /* 放到負載最低的 CPU */
+    policy->on_wake(&cpus[task->cpu], task, false);
+    ready_enqueue(task);
+    wakeup_preempt(task);
+}
+
+/*
+ * 刪除指定名稱的 task
+ *
+ * 參數：task_name - 要刪除的 task 名稱
+ * 回傳值：成功回傳 true，找不到 task 回傳 false
+ *
+ * task 設為 TERMINATED 後立即回收 (ps 仍會從 archive 顯示)；當前 task 留給 scheduler 主迴圈回收
+ */
+bool task_del(char *task_name)
+{
+    Task *target = NULL;
+    /* 尋找符合名稱的 task，若有同名 task 則取 queue 順序中最前面的 */
+    for (int i = 0; i < task_hot.count; i++) {
+        Task *ptr = task_hot.task[i];
+        if (ptr != NULL && strcmp(ptr->task_name, task_name) == 0 && (target == NULL || task_before(ptr, target))) {
+            target = ptr;
+        }
+    }
+    if (target == NULL) {
+        /* 已回收的 task：已經是 TERMINATED，不需要再做任何事 */
+        return archive_find(&task_archive, task_name) != NULL;
+    }
+
+    /* 從目前所在的 queue 移除 */
+    account(target, jiffies);
+    if (TASK_HOT(target, state) == READY) {
+        ready_dequeue(target);
+    } else if (TASK_HOT(target, state) == WAITING) {
+        list_remove(&waiting_queue, target);
+        wheel_remove(&sleep_wheel, target);
+    }
+    TASK_HOT(target, state) = TERMINATED; /* 標記為終止狀態 */
+    if (target != current_task) {
+        if (cpus[target->cpu].current == target) {
+            cpus[target->cpu].current = NULL; /* 其他 CPU 上的 task：該 CPU 不再保留它 */
+        }
+        task_reap(target);
+    }
+    return true;
+}
+
+/*
+ * ps 的一列：尚未回收的 task 與 archive 中的 task 都轉成這個格式
+ */
+typedef struct PsRow {
+    int tid;
+    const char *name;
+    int state;
+    int running;
+    int waiting;
+    int turnaround;
+    unsigned char resources; /* bit i 為資源 i */
+    int priority;
+    int cpu;        /* 所在 (或最後所在) 的 CPU */
+    int migrations; /* 在 CPU 之間移動的次數 */
+    long vruntime;  /* CFS 的 virtual runtime (us) */
+    int level;      /* MLFQ 的 level */
+    int response;   /* Response time (沒有執行過為 -1) */
+    int predict;    /* 預測的下一個 CPU burst (ms) */
+    int burst;      /* 上一個 CPU burst 的實際長度 (tick) */
+    int bursts;     /* 已結束的 CPU burst 數 */
+    long error;     /* 預測誤差 (ms) 的絕對值總和 */
+    int deadline;   /* 相對 deadline (tick，0 表示沒有) */
+    int period;     /* period (tick，0 表示只執行一次) */
+    int jobs;       /* 完成的 job 數 */
+    int misses;     /* 超過 deadline 才完成的 job 數 */
+    long lateness;  /* 最大 lateness (tick) */
+    long jitter;    /* job response time 的最大值減去最小值 (tick) */
+    PerfCounters counters; /* host 端的 CPU 時間與硬體 counter */
+} PsRow;
+
+/*
+ * Stride / Lottery：row 的 ticket 數 (與 share_tickets 相同)
+ */
+static long row_tickets(PsRow *row)
+{
+    if (row->priority < 1) {
+        return 1;
+    }
+    return row->priority < STRIDE1 ? row->priority : STRIDE1;
+}
+
+/*
+ * qsort 使用的比較函數，依 queue 順序排序 (與 task_before 相同)
+ */
+static int row_compare(const void *a, const void *b)
+{
+    const PsRow *ra = a, *rb = b;
+    if (policy->id == PP && ra->priority != rb->priority) {
+        return ra->priority < rb->priority ? -1 : 1;
+    }
+    return ra->tid < rb->tid ? -1 : (ra->tid > rb->tid ? 1 : 0);
+}
+
+/*
+ * 收集尚未回收的 task 與 archive 中的 task (尚未排序，呼叫者負責 free)
+ * 參數：total - 輸出：row 數量
+ */
+static PsRow *collect_rows(int *total)
+{
+    int count = 0;
+    PsRow *rows = (PsRow *) malloc((task_hot.count + task_archive.count + 1) * sizeof(PsRow));
+    for (int i = 0; i < task_hot.count; i++) {
+        Task *task = task_hot.task[i];
+        if (task == NULL) {
+            continue;
+        }
+        account(task, jiffies); /* 補上到目前為止的時間 */
+        PsRow *row = &rows[count++];
+        row->tid = task->tid;
+        row->name = task->task_name;
+        row->state = TASK_HOT(task, state);
+        row->running = TASK_HOT(task, running);
+        row->waiting = TASK_HOT(task, waiting);
+        row->turnaround = TASK_HOT(task, turnaround);
+        row->resources = 0;
+        for (int r = 0; r < RESOURCE_SIZE; r++) {
+            if (task->resource[r]) {
+                row->resources |= 1 << r;
+            }
+        }
+        row->priority = task->priority;
+        row->cpu = task->cpu;
+        row->migrations = task->migrations;
+        row->vruntime = task->vruntime;
+        row->level = task->mlfq_level;
+        row->response = task->response;
+        row->predict = task->burst_predict;
+        row->burst = task->burst_last;
+        row->bursts = task->burst_count;
+        row->error = task->burst_error;
+        row->deadline = task->deadline;
+        row->period = task->period;
+        row->jobs = task->jobs;
+        row->misses = task->misses;
+        row->lateness = task->lateness;
+        row->jitter = task->job_response_max - task->job_response_min;
+        row->counters = task->counters;
+    }
+    for (int i = 0; i < task_archive.count; i++) {
+        ArchiveEntry *entry = &task_archive.entries[i];
+        PsRow *row = &rows[count++];
+        row->tid = entry->tid;
+        row->name = archive_name(&task_archive, entry);
+        row->state = TERMINATED;
+        row->running = entry->running;
+        row->waiting = entry->waiting;
+        row->turnaround = entry->turnaround;
+        row->resources = entry->resources;
+        row->priority = entry->priority;
+        row->cpu = entry->cpu;
+        row->migrations = entry->migrations;
+        row->vruntime = entry->vruntime;
+        row->level = entry->mlfq_level;
+        row->response = entry->response;
+        row->predict = entry->burst_predict;
+        row->burst = entry->burst_last;
+        row->bursts = entry->burst_count;
+        row->error = entry->burst_error;
+        row->deadline = entry->deadline;
+        row->period = entry->period;
+        row->counters = entry->counters;
+        row->jobs = entry->jobs;
+        row->misses = entry->misses;
+        row->lateness = entry->lateness;
+        row->jitter = entry->jitter;
+    }
+    *total = count;
+    return rows;
+}
+
+/*
+ * ps -hw 的硬體 counter 欄位：host CPU 時間 (ms)、cycles、instructions、IPC、LLC / dTLB miss
+ */
+static void ps_counters(const PerfCounters *counters)
+{
+    const long *count = counters->count;
+    char value[PERF_EVENTS][24];
+    char ipc[16] = "-";
+
+    for (int i = 0; i < PERF_EVENTS; i++) {
+        if (perf_supported(i)) {
+            sprintf(value[i], "%ld", count[i]);
+        } else {
+            sprintf(value[i], "-");
+        }
+    }
+    if (perf_supported(PERF_CYCLES) && perf_supported(PERF_INSTRUCTIONS) && count[PERF_CYCLES] > 0) {
+        sprintf(ipc, "%.2f", (double) count[PERF_INSTRUCTIONS] / count[PERF_CYCLES]);
+    }
+    printf("|%9.1f|%13s|%13s|%5s|%10s|%10s", counters->ns / 1e6, value[PERF_CYCLES], value[PERF_INSTRUCTIONS], ipc,
+           value[PERF_LLC_MISSES], value[PERF_DTLB_MISSES]);
+}
+
+/*
+ * 顯示所有 task 的狀態資訊 (類似 Unix ps 命令)
+ *
+ * 顯示內容包括：
+ * - TID: Task ID
+ * - name: Task 名稱
+ * - state: 當前狀態 (READY/RUNNING/WAITING/TERMINATED)
+ * - running: 累計執行時間
+ * - waiting: 累計等待時間
+ * - turnaround: Turnaround time
+ * - resources: 持有的資源列表
+ * - priority: 優先權
+ *
+ * - cpu / migrations: 多 CPU 時顯示所在的 CPU 與移動次數
+ * - vruntime: CFS 時顯示 virtual runtime (ms)
+ * - level: MLFQ 時顯示所在的 level
+ * - predict / burst / error: SJF/SRTF 時顯示預測的下一個 CPU burst、上一個 burst 的實際長度
+ *   與每個 burst 預測誤差的平均 (tick)
+ * - deadline / period / jobs / misses / lateness / jitter: EDF 或有 task 指定 deadline 時顯示
+ *   相對 deadline、period、完成的 job 數、deadline miss 數、最大 lateness 與 job response time 的
+ *   變化量 (最大值減去最小值) (tick)
+ * - share / entitled: Stride / Lottery 時顯示實際得到的 CPU 時間比例 (running 占所有 task running 總和的比例)
+ *   與 ticket 數應得的比例 (priority 占所有 task ticket 總和的比例) (%)
+ * - host ms / cycles / instructions / IPC / LLC miss / dTLB miss: hw (ps -hw) 時顯示 task 執行期間
+ *   host 端的 CPU 時間與硬體 counter (perf.h)，無法開啟的 counter 顯示 "-"
+ *
+ * 顯示順序與 queue 順序相同：FCFS/RR 依 tid，PP 依優先權；已回收的 task 從 archive 取得
+ */
+void task_ps(bool hw)
+{
+    int count;
+    PsRow *rows = collect_rows(&count);
+    qsort(rows, count, sizeof(PsRow), row_compare);
+
+    bool deadlines = policy->id == EDF;
+    long running = 0, tickets = 0; /* share / entitled 的分母 */
+    for (int i = 0; i < count; i++) {
+        if (rows[i].deadline > 0) {
+            deadlines = true;
+        }
+        running += rows[i].running;
+        tickets += row_tickets(&rows[i]);
+    }
+
+    printf("%4s|%11s|%11s|%8s|%8s|%11s|%10s|%9s", "TID", "name", "state", "running", "waiting", "turnaround",
+           "resources", "priority");
+    int width = 80; /* 分隔線長度 */
+    if (nr_cpus > 1) {
+        printf("|%4s|%10s", "cpu", "migrations");
+        width += 16;
+    }
+    if (policy->id == CFS) {
+        printf("|%10s", "vruntime");
+        width += 11;
+    }
+    if (policy->id == MLFQ) {
+        printf("|%6s", "level");
+        width += 7;
+    }
+    if (sjf_family()) {
+        printf("|%8s|%6s|%6s", "predict", "burst", "error");
+        width += 23;
+    }
+    if (deadlines) {
+        printf("|%8s|%6s|%5s|%6s|%8s|%6s", "deadline", "period", "jobs", "misses", "lateness", "jitter");
+        width += 45;
+    }
+    if (policy->id == STRIDE || policy->id == LOTTERY) {
+        printf("|%8s|%8s", "share", "entitled");
+        width += 18;
+    }
+    if (hw) {
+        printf("|%9s|%13s|%13s|%5s|%10s|%10s", "host ms", "cycles", "instructions", "IPC", "LLC miss", "dTLB miss");
+        width += 66;
+    }
+    printf("\n");
+    for (int i = 0; i < width; i++) {
+        putchar('-');
+    }
+    printf("\n");
+
+    char *state[4] = {"READY", "RUNNING", "WAITING", "TERMINATED"}; /* 狀態名稱陣列 */
+    char resource[20] = {'\0'};                                     /* 資源列表字串緩衝區 */
+    char turnaround[20] = {'\0'};                                   /* Turnaround time 字串緩衝區 */
+    for (int n = 0; n < count; n++) {
+        PsRow *ptr = &rows[n];
+        int i = 0;
+        for (i = 0; i < RESOURCE_SIZE; i++) {
+            if (ptr->resources & (1 << i)) {
+                sprintf(resource + strlen(resource), "%d ", i);
+            }
+            resource[strlen(resource) - 1] = '\0';
+        }
+        if (strlen(resource) == 0) {
+            sprintf(resource, "none");
+        }
+
+        if (ptr->turnaround == 0) {
+            sprintf(turnaround, "none");
+        } else {
+            sprintf(turnaround, "%d", ptr->turnaround);
+        }
+
+        printf("%4d|%11s|%11s|%8d|%8d|%11s|%10s|%9d", ptr->tid, ptr->name, state[ptr->state], ptr->running,
+               ptr->waiting, turnaround, resource, ptr->priority);
+        if (nr_cpus > 1) {
+            printf("|%4d|%10d", ptr->cpu, ptr->migrations);
+        }
+        if (policy->id == CFS) {
+            printf("|%10ld", ptr->vruntime / 1000);
+        }
+        if (policy->id == MLFQ) {
+            printf("|%6d", ptr->level);
+        }
+        if (sjf_family()) {
+            if (ptr->bursts == 0) {
+                printf("|%8.1f|%6s|%6s", ptr->predict / 10.0, "none", "none");
+            } else {
+                printf("|%8.1f|%6d|%6.1f", ptr->predict / 10.0, ptr->burst, ptr->error / 10.0 / ptr->bursts);
+            }
+        }
+        if (deadlines) {
+            char deadline[20] = "none", period[20] = "none", lateness[20] = "none", jitter[20] = "none";
+            if (ptr->deadline > 0) {
+                sprintf(deadline, "%d", ptr->deadline);
+            }
+            if (ptr->period > 0) {
+                sprintf(period, "%d", ptr->period);
+            }
+            if (ptr->jobs > 0) {
+                sprintf(lateness, "%ld", ptr->lateness);
+                sprintf(jitter, "%ld", ptr->jitter);
+            }
+            printf("|%8s|%6s|%5d|%6d|%8s|%6s", deadline, period, ptr->jobs, ptr->misses, lateness, jitter);
+        }
+        if (policy->id == STRIDE || policy->id == LOTTERY) {
+            printf("|%8.3f|%8.3f", running > 0 ? 100.0 * ptr->running / running : 0.0,
+                   100.0 * row_tickets(ptr) / tickets);
+        }
+        if (hw) {
+            ps_counters(&ptr->counters);
+        }
+        printf("\n");
+    }
+    free(rows);
+
+    if (hw && virtual_mode) {
+        printf("Host counters are not collected in virtual mode.\n");
+    } else if (hw && !perf_supported(PERF_CYCLES) && !perf_supported(PERF_INSTRUCTIONS)) {
+        printf("Hardware counters are unavailable (perf_event_open), showing host CPU time only.\n");
+    }
+}
+
+/*
+ * 計算所有 task 的平均時間 (單位與 ps 相同，為 10ms)
+ *
+ * - waiting / turnaround: 只計算已經 TERMINATED 的 task
+ * - response: 加入系統後到第一次執行的時間，只計算已經執行過的 task
+ * - share_error: 實際 CPU 比例與 ticket 比例的差距
+ *   (total variation distance：各 task 比例差的絕對值總和的一半)，越接近 0 表示越接近 ticket 比例
+ * - switches: 所有 CPU 上 dispatch 的 task 與上一個執行的 task 不同的次數
+ */
+void task_stats(TaskStats *stats)
+{
+    long waiting = 0, turnaround = 0, response = 0;
+    int responded = 0;
+    long running = 0, tickets = 0;
+    int count;
+    PsRow *rows = collect_rows(&count);
+
+    memset(stats, 0, sizeof(TaskStats));
+    stats->tasks = count;
+    for (int i = 0; i < count; i++) {
+        if (rows[i].state == TERMINATED) {
+            waiting += rows[i].waiting;
+            turnaround += rows[i].turnaround;
+            stats->finished++;
+        }
+        if (rows[i].response >= 0) {
+            response += rows[i].response;
+            responded++;
+        }
+        stats->jobs += rows[i].jobs;
+        stats->misses += rows[i].misses;
+        running += rows[i].running;
+        tickets += row_tickets(&rows[i]);
+    }
+    for (int i = 0; i < count && running > 0; i++) {
+        stats->share_error += fabs((double) rows[i].running / running - (double) row_tickets(&rows[i]) / tickets) / 2;
+    }
+    free(rows);
+
+    if (stats->finished > 0) {
+        stats->waiting = (double) waiting / stats->finished;
+        stats->turnaround = (double) turnaround / stats->finished;
+    }
+    if (responded > 0) {
+        stats->response = (double) response / responded;
+    }
+    stats->ticks = jiffies;
+    stats->delay_p99 = hist_percentile(&latency_total.delay, 99);
+    stats->wakeup_p99 = hist_percentile(&latency_total.wakeup, 99);
+    for (int i = 0; i < nr_cpus; i++) {
+        stats->switches += cpus[i].switches;
+    }
+}
+
+/*
+ * 顯示所有 task 的平均時間，用來比較不同演算法在同一個工作負載下的表現 (見 task_stats)
+ *
+ * - misses: 有 deadline 的 task 時顯示 deadline miss 數與完成的 job 數
+ * - share error: Stride / Lottery 時顯示 (%)
+ */
+void task_summary()
+{
+    TaskStats stats;
+    task_stats(&stats);
+
+    printf("%-12s%s\n", "algorithm", policy->name);
+    printf("%-12s%d (%d finished)\n", "tasks", stats.tasks, stats.finished);
+    printf("%-12s%.2f\n", "waiting", stats.waiting);
+    printf("%-12s%.2f\n", "turnaround", stats.turnaround);
+    printf("%-12s%.2f\n", "response", stats.response);
+    printf("%-12s%ld\n", "switches", stats.switches);
+    if (stats.jobs > 0) {
+        printf("%-12s%d (%d jobs)\n", "misses", stats.misses, stats.jobs);
+    }
+    if (policy->id == STRIDE || policy->id == LOTTERY) {
+        printf("%-12s%.3f%%\n", "share error", 100 * stats.share_error);
+    }
+}
+
+/*
+ * stats 的一列
+ */
+typedef struct LatencyRow {
+    int tid;
+    const char *name;
+    const TaskLatency *latency;
+} LatencyRow;
+
+static int latency_row_compare(const void *a, const void *b)
+{
+    const LatencyRow *ra = a, *rb = b;
+    return ra->tid < rb->tid ? -1 : (ra->tid > rb->tid ? 1 : 0);
+}
+
+/*
+ * 一個 histogram 的 p50/p90/p99/max (沒有記錄時為 none)
+ */
+static void print_percentiles(const Histogram *hist)
+{
+    char cell[64];
+    if (hist->count == 0) {
+        snprintf(cell, sizeof(cell), "none");
+    } else {
+        snprintf(cell, sizeof(cell), "%ld/%ld/%ld/%ld", hist_percentile(hist, 50), hist_percentile(hist, 90),
+                 hist_percentile(hist, 99), hist->max);
+    }
+    printf("|%24s", cell);
+}
+
+/*
+ * 顯示每個 task 與所有 task 的延遲分布 (p50/p90/p99/max，單位：tick)
+ *
+ * - delay: scheduling delay，每次從進入 READY 到被 dispatch
+ * - wakeup: wakeup latency，sleep 結束 (或等待資源的 task 重新檢查) 到被 dispatch
+ * - burst: CPU burst 的長度
+ * 依 tid 排序；已回收的 task 從 archive 還原，最後一列 all 為目前演算法下所有 task 的分布
+ */
+void task_latency()
+{
+    int count = 0, archived = 0;
+    LatencyRow *rows = (LatencyRow *) malloc((task_hot.count + task_archive.count + 1) * sizeof(LatencyRow));
+    TaskLatency *restored = (TaskLatency *) malloc((task_archive.count + 1) * sizeof(TaskLatency));
+    if (rows == NULL || restored == NULL) {
+        perror("task_latency");
+        exit(1);
+    }
+    for (int i = 0; i < task_hot.count; i++) {
+        Task *task = task_hot.task[i];
+        if (task != NULL) {
+            rows[count++] = (LatencyRow) {task->tid, task->task_name, task->latency};
+        }
+    }
+    for (int i = 0; i < task_archive.count; i++) {
+        ArchiveEntry *entry = &task_archive.entries[i];
+        archive_latency(&task_archive, entry, &restored[archived]);
+        rows[count++] = (LatencyRow) {entry->tid, archive_name(&task_archive, entry), &restored[archived++]};
+    }
+    qsort(rows, count, sizeof(LatencyRow), latency_row_compare);
+
+    printf("%4s|%11s|%24s|%24s|%24s\n", "TID", "name", "delay p50/p90/p99/max", "wakeup p50/p90/p99/max",
+           "burst p50/p90/p99/max");
+    for (int i = 0; i < count; i++) {
+        printf("%4d|%11s", rows[i].tid, rows[i].name);
+        print_percentiles(&rows[i].latency->delay);
+        print_percentiles(&rows[i].latency->wakeup);
+        print_percentiles(&rows[i].latency->burst);
+        printf("\n");
+    }
+    printf("%4s|%11s", "all", policy->name);
+    print_percentiles(&latency_total.delay);
+    print_percentiles(&latency_total.wakeup);
+    print_percentiles(&latency_total.burst);
+    printf("\n");
+    printf("(tick) %ld dispatches, %ld wakeups, %ld bursts\n", latency_total.delay.count, latency_total.wakeup.count,
+           latency_total.burst.count);
+    free(restored);
+    free(rows);
+}
+
+/*
+ * Tickless：以 getitimer 的剩餘時間計算上次同步後經過的 virtual time，更新 jiffies
+ */
+static void clock_sync()
+{
+    struct itimerval value;
+    long remaining;
+
+    getitimer(ITIMER_VIRTUAL, &value);
+    remaining = value.it_value.tv_sec * 1000000L + value.it_value.tv_usec;
+    if (remaining > timer_armed_us) {
+        remaining = timer_armed_us;
+    }
+    virtual_us += timer_armed_us - remaining;
+    timer_armed_us = remaining;
+    jiffies = virtual_us / TICK_US;
+}
+
+/*
+ * Tickless：設定 one-shot timer 到下一個事件
+ *
+ * 事件包括當前 task 的 RR 時間片用完與 timer wheel 中最早的喚醒；
+ * 都沒有時仍以 TICKLESS_HORIZON 為上限設定 timer，讓 virtual time 持續被計算
+ */
+static void program_timer()
+{
+    struct itimerval value;
+    long next, wake;
+
+    clock_sync(); /* 先計入上次同步後經過的時間，避免重新設定 timer 時遺失 */
+    next = jiffies + TICKLESS_HORIZON;
+    wake = wheel_next_expiry(&sleep_wheel);
+
+    if (wake >= 0 && wake < next) {
+        next = wake;
+    }
+    if (time_sliced() && current_task != NULL && TASK_HOT(current_task, state) == RUNNING) {
+        long expiry = current_task->state_tick + TASK_HOT(current_task, time_quantum) / 10;
+        if (expiry < next) {
+            next = expiry;
+        }
+    }
+    if (next <= jiffies) {
+        next = jiffies + 1;
+    }
+
+    timer_armed_us = next * TICK_US - virtual_us;
+    value.it_value.tv_sec = timer_armed_us / 1000000;
+    value.it_value.tv_usec = timer_armed_us % 1000000;
+    value.it_interval.tv_sec = 0; /* one-shot */
+    value.it_interval.tv_usec = 0;
+    setitimer(ITIMER_VIRTUAL, &value, NULL);
+}
+
+/*
+ * 設定 timer，每 10ms 觸發一次 SIGVTALRM signal
+ *
+ * 使用 ITIMER_VIRTUAL：只計算 process 在 user mode 執行的時間
+ * 這確保了時間統計的準確性
+ */
+void set_timer()
+{
+    struct itimerval value;
+    if (virtual_mode) {
+        return; /* virtual 模式不使用 timer */
+    }
+    if (tickless) {
+        program_timer();
+        return;
+    }
+    value.it_value.tv_sec = 0;             /* 初始延遲：0 s */
+    value.it_value.tv_usec = 10 * 1000;    /* 初始延遲：10 ms */
+    value.it_interval.tv_sec = 0;          /* 間隔時間：0 s */
+    value.it_interval.tv_usec = 10 * 1000; /* 間隔時間：10 ms */
+    setitimer(ITIMER_VIRTUAL, &value, NULL);
+}
+
+/*
+ * 關閉 timer，停止產生 SIGVTALRM signal
+ */
+void close_timer()
+{
+    struct itimerval value;
+    if (virtual_mode) {
+        return;
+    }
+    if (tickless) {
+        /* 同步 virtual time 後捨棄不足一個 tick 的部分 (與週期性模式恢復時重新計時相同) */
+        clock_sync();
+        virtual_us = jiffies * TICK_US;
+        timer_armed_us = 0;
+    }
+    value.it_value.tv_sec = 0; /* 設定為 0 表示停止 timer */
+    value.it_value.tv_usec = 0;
+    value.it_interval.tv_sec = 0;
+    value.it_interval.tv_usec = 0;
+    setitimer(ITIMER_VIRTUAL, &value, NULL);
+}
+
+/*
+ * Timer wheel 的到期處理：sleep 結束 (或等待資源的 task 到了重試時間)，回到 READY
+ */
+static void wake_up(Task *task)
+{
+    account(task, task->wake_tick); /* tickless 模式可能較晚才處理，從到期的 tick 開始算 READY */
+    list_remove(&waiting_queue, task);
+    policy->on_wake(&cpus[task->cpu], task, true);
+    emit(EV_WAKE, task, 0, 0);
+    ready_enqueue(task);
+    task->ready_tick = task->wake_tick;
+    task->woken = true;
+    wakeup_preempt(task);
+}
+
+/*
+ * 處理一個 tick 的狀態與時間更新
+ *
+ * 參數：
+ *   running - 輸出：是否有 task 在執行
+ *   ready - 輸出：是否有 task 從 WAITING 變為 READY
+ *
+ * 只處理每個 CPU 上執行中的 task 與到期的事件：其他 task 的 running / waiting / turnaround
+ * 在狀態轉換時由 account() 依 state_tick 補上，每個 tick 的成本與 task 數無關
+ */
+static void scheduler_tick(bool *running, bool *ready)
+{
+    /* 每個 CPU 的 RUNNING task：Round Robin / CFS / MLFQ 管理時間片 */
+    for (int i = 0; i < nr_cpus; i++) {
+        Task *task = cpus[i].current;
+        if (task == NULL || TASK_HOT(task, state) != RUNNING) {
+            cpus[i].idle_ticks++;
+            continue;
+        }
+        cpus[i].busy_ticks++;
+        if (i == this_cpu) {
+            *running = true;
+        }
+        policy->on_tick(&cpus[i], task, 1);
+        if (time_sliced() && TASK_HOT(task, time_quantum) > 0) {
+            TASK_HOT(task, time_quantum) -= 10; /* 減少剩餘時間片 */
+            /* 時間片用完，設為 READY 狀態 (M:N 模式下 task 仍在其他 worker 上執行，由該 worker 保存 context 後再放入) */
+            if (TASK_HOT(task, time_quantum) <= 0 && nr_workers == 0) {
+                account(task, jiffies + 1); /* 這個 tick 仍在執行，從下一個 tick 開始算 READY */
+                ready_enqueue(task);
+            }
+        }
+    }
+
+    /* Timer wheel：只處理在這個 tick 到期的 task，讓它們回到 READY */
+    jiffies++;
+    policy->on_clock(jiffies);
+    if (wheel_run(&sleep_wheel, jiffies, wake_up) > 0) {
+        *ready = true;
+    }
+
+    /* 多 CPU：定期 load balancing，沒有工作的 CPU 嘗試 work stealing */
+    if (nr_cpus > 1) {
+        if (jiffies % BALANCE_INTERVAL == 0) {
+            load_balance();
+        }
+        idle_steal();
+    }
+}
+
+/*
+ * 多 CPU：取得編號在 from 之後、有工作的下一個 CPU
+ * 回傳值：CPU 編號，沒有時回傳 -1
+ */
+static int cpu_next_busy(int from)
+{
+    for (int i = from + 1; i < nr_cpus; i++) {
+        if (cpu_load(&cpus[i]) > 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/*
+ * 判斷 host thread 目前是否在 task 的 stack 上執行 (而不是 scheduler 主迴圈或 idle)
+ */
+static bool on_task_stack(Task *task)
+{
+    char probe;
+    uintptr_t sp = (uintptr_t) &probe;
+    return task != NULL && task->stack != NULL && sp >= (uintptr_t) task->stack &&
+           sp < (uintptr_t) task->stack + STACK_SIZE;
+}
+
+/*
+ * 多 CPU 的 SIGVTALRM 處理：目前 CPU 的 host 時間片結束
+ *
+ * 依序換到下一個有工作的 CPU，所有有工作的 CPU 都執行過一次 (輪到最後) 才經過一個 tick。
+ * 被打斷的 task 先保存 context，之後由 scheduler 主迴圈在它所在的 CPU 上恢復
+ * (可能因 work stealing 已在另一個 CPU 上)。
+ * signal 若打斷的是 scheduler 主迴圈 (例如 dispatch 之後、切換到 task 之前)，
+ * 不保存任何 context，直接讓主迴圈為下一個 CPU 重新選擇。
+ */
+static void cpu_slice_end()
+{
+    Task *host = on_task_stack(current_task) ? current_task : NULL;
+    volatile bool resumed = false;
+    bool running = false; /* 是否有 task 在執行 */
+    bool ready = false;   /* 是否有 task 從 WAITING 變為 READY */
+
+    /* 打斷的是 scheduler 主迴圈 (不是 idle)：主迴圈馬上會切換到 task，不在這裡跳走 */
+    bool in_scheduler = host == NULL && !is_idle;
+
+    if (host != NULL) {
+        context_save(&(host->context));
+        if (resumed) {
+            return; /* 被重新排程後從這裡返回 */
+        }
+        resumed = true;
+    }
+
+    int slices = 1 + tick_pending;
+    int next = this_cpu;
+    tick_pending = 0;
+    while (slices-- > 0) {
+        next = cpu_next_busy(next);
+        if (next < 0) {
+            scheduler_tick(&running, &ready);
+            next = cpu_next_busy(-1);
+            if (next < 0) {
+                next = this_cpu; /* 所有 CPU 都沒有工作 */
+            }
+        }
+    }
+
+    /* 同一個 CPU 繼續：被打斷的 task 仍在執行，或 idle 且仍沒有工作 */
+    if (in_scheduler || (next == this_cpu && ((host != NULL && TASK_HOT(host, state) == RUNNING && current_task == host) ||
+                                              (is_idle && cpu_load(&cpus[this_cpu]) == 0)))) {
+        sched_unlock();
+        return;
+    }
+
+    if (host != NULL) {
+        switch_start = handler_start; /* host 在 handler 進入時離開 CPU，由主迴圈載入下一個 task */
+    }
+    this_cpu = next;
+    sched_unlock();
+    context_load(&current_context);
+}
+
+/*
+ * Tickless：同步 virtual time，並喚醒到現在為止到期的 task
+ * 回傳值：是否有 task 從 WAITING 變為 READY (週期性模式下不做任何事，回傳 false)
+ */
+static bool clock_advance()
+{
+    if (!tickless) {
+        return false;
+    }
+    clock_sync();
+    policy->on_clock(jiffies);
+    return wheel_run(&sleep_wheel, jiffies, wake_up) > 0;
+}
+
+/*
+ * Tickless 模式的 handler 處理：取代逐 tick 的 scheduler_tick
+ *
+ * 參數與 scheduler_tick 相同；時間統計不在這裡累加，而是在狀態轉換時由 account() 補上
+ */
+static void tickless_event(bool *running, bool *ready)
+{
+    if (clock_advance()) {
+        *ready = true;
+    }
+
+    /* RUNNING task：Round Robin / CFS / MLFQ 的時間片在 state_tick 後 time_quantum / 10 個 tick 用完 */
+    if (current_task != NULL && TASK_HOT(current_task, state) == RUNNING) {
+        *running = true;
+        if (time_sliced() && TASK_HOT(current_task, time_quantum) > 0 &&
+            jiffies >= current_task->state_tick + TASK_HOT(current_task, time_quantum) / 10) {
+            account(current_task, jiffies);
+            ready_enqueue(current_task);
+        }
+    }
+}
+
+/*
+ * SIGVTALRM signal handler
+ *
+ * 每 10ms 觸發一次 (tickless 模式下只在下一個事件時觸發)，負責：
+ * 1. 更新所有 task 的時間統計 (running/waiting/turnaround)
+ * 2. 喚醒 sleep 時間到期的 task (timer wheel)
+ * 3. Round Robin 的時間片管理
+ * 4. 觸發 context switch (如果需要)
+ *
+ * 若 signal 打斷了 scheduler critical section，只記錄 tick 數，
+ * 留到下一次 handler 執行時一併處理
+ */
+void signal_handler()
+{
+    Task *next_task = NULL;
+    bool running = false; /* 是否有 task 在執行 */
+    bool ready = false;   /* 是否有 task 從 WAITING 變為 READY */
+
+    if (sched_locked) {
+        tick_pending++;
+        return;
+    }
+    handler_start = overhead_stamp();
+    sched_lock();
+
+    if (nr_cpus > 1) {
+        cpu_slice_end();
+        return;
+    }
+
+    if (tickless) {
+        /* 經過的時間由 clock_sync 取得，被延後的 signal 不需要補做 */
+        tick_pending = 0;
+        tickless_event(&running, &ready);
+    } else {
+        /* 處理本次 tick 與之前被延後的 tick */
+        int ticks = 1 + tick_pending;
+        tick_pending = 0;
+        while (ticks-- > 0) {
+            scheduler_tick(&running, &ready);
+        }
+    }
+
+    /* Round Robin / CFS / MLFQ: 檢查當前 task 的時間片是否用完 */
+    if (time_sliced() && current_task != NULL && TASK_HOT(current_task, time_quantum) <= 0) {
+        next_task = slice_next(current_task); /* 找下一個 READY 的 task */
+    }
+
+    /* Round Robin: 執行 context switch */
+    if (next_task != NULL) {
+        context_save(&(current_task->context)); /* 儲存當前 task 的 context */
+        if (TASK_HOT(current_task, time_quantum) <= 0) {
+            print_running(next_task, current_task == next_task);
+            if (current_task != next_task) {
+                switch_start = handler_start; /* 被打斷的 task 在 handler 進入時離開 CPU */
+            }
+            dispatch(next_task); /* 重設時間片 (RR 預設 30ms，3個 tick) */
+            counters_switch(next_task); /* 被打斷的 task 的 counter 到這裡為止 */
+            if (event_crowded()) {
+                /* event ring 快滿：先回到 scheduler 主迴圈 (handler 之外) drain，再由主迴圈切換到 next_task */
+                handoff = next_task;
+                sched_unlock();
+                context_load(&current_context);
+            }
+            switch_end();
+            sched_unlock();
+            context_load(&(next_task->context)); /* 切換到下一個 task */
+        }
+        return; /* task 被重新排程後從這裡返回 */
+    }
+
+    sched_unlock();
+
+    /* 如果 CPU idle 但有 task 變為 READY，回到 scheduler 主迴圈 */
+    if (is_idle && !running && ready) {
+        context_load(&current_context);
+    }
+}
+
+/*
+ * SIGTSTP (Signal Terminal Stop) signal handler (Ctrl+Z)
+ *
+ * 處理模擬暫停：
+ * 1. 儲存當前 context
+ * 2. 關閉 timer
+ * 3. 回到 shell 模式
+ *
+ * 若打斷了 scheduler critical section，延後到 sched_unlock() 時處理
+ */
+void pause_handler()
+{
+    if (sched_locked) {
+        pause_pending = 1;
+        return;
+    }
+    pause = true;
+    /* 儲存暫停時的 context，以便之後恢復 */
+    context_save(&pause_context);
+    if (pause) {
+        close_timer();                /* 停止 timer */
+        counters_switch(NULL);        /* 暫停期間 (shell) 的 host CPU 時間不計入 task */
+        context_load(&current_context); /* 回到 scheduler 主迴圈 */
+    } else {
+        set_timer(); /* 恢復 timer (當從暫停恢復時) */
+        /* 暫停期間當前 task 被 del：不再回到它的 context，改由 scheduler 選擇下一個 task */
+        if (!is_idle && current_task != NULL && TASK_HOT(current_task, state) == TERMINATED) {
+            context_load(&current_context);
+        }
+        counters_switch(is_idle ? NULL : current_task);
+    }
+}
+
+/*
+ * M:N 模式的 SIGVTALRM handler (每個 worker 的 per-thread timer)
+ *
+ * CPU 0 的 worker 負責推進全域的 tick (時間統計、timer wheel、load balancing)，
+ * 其他 worker 只處理自己 CPU 上的 task：時間片用完 (RR) 或要停止 (暫停 / 模擬結束) 時
+ * 保存被打斷的 task 並回到自己的主迴圈；idle 時有 READY task 也回到主迴圈。
+ * 打斷的位置不是 safe point (在 libc 中) 時不切換，留到下一個 tick 再試。
+ */
+static void worker_handler(int signum, siginfo_t *info, void *ucontext)
+{
+    Task *host;
+    volatile bool resumed = false;
+    bool running = false; /* 是否有 task 在執行 */
+    bool ready = false;   /* 是否有 task 從 WAITING 變為 READY */
+
+    if (sched_locked) {
+        tick_pending++;
+        return;
+    }
+    handler_start = overhead_stamp();
+    sched_lock();
+
+    bool stop = worker_stop != WORKER_RUN;
+    if (this_cpu == 0 && !stop) {
+        int ticks = 1 + tick_pending;
+        while (ticks-- > 0) {
+            scheduler_tick(&running, &ready);
+        }
+    }
+    tick_pending = 0;
+
+    host = on_task_stack(current_task) ? current_task : NULL;
+    if (host != NULL) {
+        bool expired = time_sliced() && TASK_HOT(host, time_quantum) <= 0;
+        if (!(expired || stop) || !worker_safe_point(ucontext)) {
+            sched_unlock();
+            return;
+        }
+        context_save(&(host->context));
+        if (resumed) {
+            return; /* 被重新排程 (可能在另一個 worker 上) 後從這裡返回 */
+        }
+        resumed = true;
+        if (expired) {
+            account(host, jiffies);
+            ready_enqueue(host); /* 主迴圈從它的下一個開始選擇 */
+        }
+        switch_start = handler_start;
+    } else if (!is_idle || (!stop && cpu_load(&cpus[this_cpu]) == 0) || !worker_safe_point(ucontext)) {
+        /* scheduler 主迴圈中 (馬上會切換到 task)，或 idle 且仍沒有工作 */
+        sched_unlock();
+        return;
+    }
+    switch_to_scheduler();
+}
+
+/*
+ * M:N 模式的 SIGTSTP handler：通知所有 worker 在下一個 tick 停止
+ */
+static void worker_pause()
+{
+    __sync_bool_compare_and_swap(&worker_stop, WORKER_RUN, WORKER_PAUSE);
+}
+
+/*
+ * Virtual 模式：當前 task 在 CPU burst 中，把 virtual clock 推進到下一個事件
+ *
+ * 事件為 burst 結束或 Round Robin 時間片用完 (FCFS/PP 中 task 被喚醒不會搶佔，
+ * 因此期間到期的 sleep 只需在推進後一併處理)。時間片用完時與 signal_handler 相同，
+ * 從當前 task 的下一個 READY task 開始選擇
+ */
+static void virtual_advance()
+{
+    Task *task = current_task;
+    long next = jiffies + (task->burst_left > 0 ? task->burst_left : VIRTUAL_HORIZON);
+
+    if (time_sliced() && task->state_tick + TASK_HOT(task, time_quantum) / 10 < next) {
+        next = task->state_tick + TASK_HOT(task, time_quantum) / 10;
+    }
+    /* SRTF / EDF：被喚醒 (或 release) 的 task 可能搶佔當前 task，喚醒也是事件 */
+    long wake = wheel_next_expiry(&sleep_wheel);
+    if ((policy->flags & POLICY_PREEMPT) && wake >= 0 && wake < next) {
+        next = wake;
+    }
+    if (next <= jiffies) {
+        next = jiffies + 1;
+    }
+    if (task->burst_left > 0) {
+        task->burst_left -= next - jiffies;
+    }
+    jiffies = next;
+    policy->on_clock(jiffies);
+    wheel_run(&sleep_wheel, jiffies, wake_up);
+
+    /* Round Robin / CFS / MLFQ: 時間片用完，切換到下一個 READY task (可能是自己) */
+    if (time_sliced() && jiffies >= task->state_tick + TASK_HOT(task, time_quantum) / 10) {
+        account(task, jiffies);
+        ready_enqueue(task);
+        Task *next_task = slice_next(task);
+        print_running(next_task, next_task == task);
+        dispatch(next_task);
+    }
+}
+
+/*
+ * Virtual 模式：CPU idle 時直接把 virtual clock 推進到有 task 被喚醒的 tick
+ */
+static void virtual_idle()
+{
+    long start = jiffies;
+    sched_lock();
+    while (true) {
+        long next = wheel_next_expiry(&sleep_wheel);
+        if (next < 0) {
+            break;
+        }
+        jiffies = next > jiffies ? next : jiffies;
+        if (wheel_run(&sleep_wheel, jiffies, wake_up) > 0) {
+            break;
+        }
+    }
+    for (int i = 0; i < nr_cpus; i++) {
+        cpus[i].idle_ticks += jiffies - start;
+    }
+    policy->on_clock(jiffies);
+    sched_unlock();
+}
+
+/*
+ * 停止 ITIMER_VIRTUAL (tickless 模式下先同步 virtual time)
+ * 回傳值：週期性模式下到下一個 tick 剩餘的時間 (us)
+ */
+static long virtual_timer_stop()
+{
+    struct itimerval value = {{0, 0}, {0, 0}};
+    struct itimerval old;
+
+    if (tickless) {
+        clock_sync();
+        timer_armed_us = 0;
+    }
+    setitimer(ITIMER_VIRTUAL, &value, &old);
+    return old.it_value.tv_sec * 1000000L + old.it_value.tv_usec;
+}
+
+/*
+ * 所有 CPU 都沒有工作時的 idle (單一 host thread)：不佔用 host CPU
+ *
+ * ITIMER_VIRTUAL 只計算 user mode 的 CPU 時間，原本的 idle 迴圈必須持續執行才能讓 tick 前進。
+ * 這裡改為停止 ITIMER_VIRTUAL，以 clock_nanosleep 阻塞 (wall-clock) 到下一個喚醒
+ * (sleep 到期、等待資源的 task 重試或 periodic task 的 release) 的 tick，醒來後一次補上經過的 tick。
+ * 期間不會有其他事件，模擬的時間與 idle 迴圈相同：週期性模式下第一個 tick 在 timer 剩餘的時間後，
+ * 之後每 10ms 一個 tick；tickless 模式下 virtual time 直接推進到喚醒的 tick。
+ * Ctrl+Z 打斷等待，恢復時 clock_nanosleep 回傳剩餘的時間 (暫停的期間不計入)，繼續等待。
+ *
+ * 呼叫時持有 lock，返回時仍持有 lock
+ * 回傳值：是否已推進到有 task 被喚醒 (M:N 模式、其他 CPU 仍有工作或沒有任何喚醒時回傳 false，
+ *         呼叫者改用 idle 迴圈)
+ */
+static bool idle_wait()
+{
+    bool running = false; /* 是否有 task 在執行 */
+    bool ready = false;   /* 是否有 task 從 WAITING 變為 READY */
+
+    if (nr_workers > 0 || !cpu_all_idle() || wheel_next_expiry(&sleep_wheel) < 0) {
+        return false;
+    }
+
+    /* 停止 timer 前被延後的 tick (tickless 模式下由 clock_advance 同步) */
+    long first_us = virtual_timer_stop();
+    if (tickless) {
+        ready = clock_advance();
+    }
+    while (!tickless && tick_pending > 0) {
+        tick_pending--;
+        scheduler_tick(&running, &ready);
+    }
+    tick_pending = 0;
+
+    if (!ready) {
+        long next = wheel_next_expiry(&sleep_wheel);
+        long wait_us;
+        if (tickless) {
+            wait_us = next * TICK_US - virtual_us;
+        } else {
+            wait_us = (first_us > 0 ? first_us : TICK_US) + (next - jiffies - 1) * TICK_US;
+        }
+        struct timespec left = {wait_us / 1000000, wait_us % 1000000 * 1000};
+
+        sched_unlock();
+        while (wait_us > 0 && clock_nanosleep(CLOCK_MONOTONIC, 0, &left, &left) == EINTR) {
+        }
+        sched_lock();
+        schedule_start = overhead_stamp();
+
+        /* 恢復暫停時 timer 可能已被重新設定 */
+        virtual_timer_stop();
+        tick_pending = 0;
+        if (tickless) {
+            virtual_us = next * TICK_US;
+            jiffies = next;
+            clock_advance();
+        }
+        while (jiffies < next) {
+            scheduler_tick(&running, &ready);
+        }
+    }
+
+    /* 重新開始計時：週期性模式下下一個 tick 在 10ms 後 (與 idle 迴圈中 tick 剛觸發時相同) */
+    set_timer();
+    if (nr_cpus > 1) {
+        int next_cpu = cpu_next_busy(-1);
+        this_cpu = next_cpu >= 0 ? next_cpu : this_cpu;
+    }
+    return true;
+}
+
+/*
+ * Virtual 模式的多 CPU：選擇下一個需要 host 執行的 CPU，都不需要時推進 virtual clock
+ *
+ * 需要 host 的 CPU：執行中的 task 的 CPU burst 已結束 (要繼續執行 script)，
+ * 或沒有執行中的 task 但 ready queue 不為空。其餘 CPU 在 CPU burst 中或沒有工作，
+ * 此時把 virtual clock 推進到最早的事件 (任一 CPU 的 burst 結束、RR 時間片用完、sleep 到期)，
+ * 所有 CPU 的 burst 同時推進。
+ *
+ * 回傳值：false 表示沒有任何 CPU 在執行 (呼叫者進入 idle 或結束模擬)
+ */
+static bool virtual_cpu_next()
+{
+    long next = -1;
+
+    idle_steal();
+    for (int i = 0; i < nr_cpus; i++) {
+        Task *task = cpus[i].current;
+        bool running = task != NULL && TASK_HOT(task, state) == RUNNING;
+        if ((running && task->burst_left == 0) || (!running && cpus[i].nr_ready > 0)) {
+            this_cpu = i;
+            return true;
+        }
+        if (running) {
+            long end = jiffies + (task->burst_left > 0 ? task->burst_left : VIRTUAL_HORIZON);
+            if (time_sliced() && task->state_tick + TASK_HOT(task, time_quantum) / 10 < end) {
+                end = task->state_tick + TASK_HOT(task, time_quantum) / 10;
+            }
+            if (next < 0 || end < next) {
+                next = end;
+            }
+        }
+    }
+    if (next < 0) {
+        return false;
+    }
+
+    /* sleep 到期的 task 可能讓沒有工作的 CPU 開始執行 */
+    long wake = wheel_next_expiry(&sleep_wheel);
+    if (wake >= 0 && wake < next) {
+        next = wake;
+    }
+    if (next <= jiffies) {
+        next = jiffies + 1;
+    }
+
+    long delta = next - jiffies;
+    for (int i = 0; i < nr_cpus; i++) {
+        Task *task = cpus[i].current;
+        if (task != NULL && TASK_HOT(task, state) == RUNNING) {
+            cpus[i].busy_ticks += delta;
+            if (task->burst_left > 0) {
+                task->burst_left -= delta;
+            }
+        } else {
+            cpus[i].idle_ticks += delta;
+        }
+    }
+    bool balance = next / BALANCE_INTERVAL != jiffies / BALANCE_INTERVAL;
+    jiffies = next;
+    policy->on_clock(jiffies);
+    wheel_run(&sleep_wheel, jiffies, wake_up);
+
+    /* Round Robin / CFS / MLFQ：時間片用完的 task 回到 ready queue，由主迴圈選擇下一個 */
+    for (int i = 0; i < nr_cpus; i++) {
+        Task *task = cpus[i].current;
+        if (time_sliced() && task != NULL && TASK_HOT(task, state) == RUNNING &&
+            jiffies >= task->state_tick + TASK_HOT(task, time_quantum) / 10) {
+            account(task, jiffies);
+            ready_enqueue(task);
+        }
+    }
+    if (balance) {
+        load_balance();
+    }
+    return true;
+}
+
+/*
+ * 註冊 signal handler
+ *
+ * handler 可能直接切換到其他 task 而不返回。ucontext backend 切換時會還原目標 context
+ * 的 signal mask；asm backend 不處理 signal mask，進入 handler 時被 kernel 阻擋的 signal
+ * 將不會被解除，因此改用 SA_NODEFER，handler 執行期間不阻擋同一個 signal
+ * (重入由 sched_locked 處理：critical section 外重入的 handler 不會切換 context)
+ *
+ * flags 為 SA_SIGINFO 時 handler 為 (int, siginfo_t *, void *) 形式
+ */
+static void install_handler(int signum, void (*handler)(), int flags)
+{
+    struct sigaction action;
+    if (flags & SA_SIGINFO) {
+        action.sa_sigaction = (void (*)(int, siginfo_t *, void *)) handler;
+    } else {
+        action.sa_handler = handler;
+    }
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART | flags;
+    if (context_backend == CONTEXT_ASM) {
+        action.sa_flags |= SA_NODEFER;
+    }
+    sigaction(signum, &action, NULL);
+}
+
+/*
+ * Scheduler 主迴圈
+ *
+ * 處理 task 的執行和切換；暫停 (Ctrl+Z) 或所有 task 都完成時返回。
+ * M:N 模式下每個 worker thread 各自執行這個迴圈，負責自己的 CPU
+ */
+static void schedule()
+{
+    while (true) {
+        /* 設定返回點：當呼叫 context_load(&current_context) 時會跳到這裡 */
+        context_save(&current_context);
+
+        /* 檢查是否按了 Ctrl+Z */
+        if (pause) {
+            pause = false;
+            break; /* 返回 shell */
+        }
+
+        /* M:N 模式下從 task 或 handler 切換回來時仍持有 lock (見 switch_to_scheduler) */
+        if (!sched_locked) {
+            sched_lock();
+        }
+        overhead_flush(); /* M:N 模式下從 handler 切換回來時仍在計算 handler 的時間 */
+        schedule_start = overhead_stamp();
+        counters_switch(NULL); /* 回到主迴圈：上一個 task 已經離開 CPU */
+        event_drain(); /* 輸出上一次進入主迴圈之後的事件 (回收 task 之前) */
+        if (handoff != NULL) {
+            /* handler 已經 dispatch 的 task (見 signal_handler)：drain 之後直接切換過去 */
+            Task *task = handoff;
+            handoff = NULL;
+            switch_end();
+            counters_switch(task);
+            sched_unlock();
+            context_load(&(task->context));
+        }
+        if (worker_stop != WORKER_RUN) {
+            sched_unlock();
+            break; /* M:N 模式：Ctrl+Z 或模擬已經結束 */
+        }
+        clock_advance();
+        is_idle = false;
+        Task *next_task = NULL;
+        bool expired = false; /* 多 CPU：當前 task 的時間片已用完 */
+
+        /* 已經切換回 scheduler，上一個 task 若已結束即可回收 */
+        if (current_task != NULL && TASK_HOT(current_task, state) == TERMINATED) {
+            /* Round Robin: 從終止 task 的下一個開始找 */
+            if (policy->flags & POLICY_CIRCULAR) {
+                next_task = slice_next(current_task);
+            }
+            task_reap(current_task);
+            current_task = NULL;
+        }
+
+        /* 多 CPU 或 M:N，使用時間片的演算法: 時間片用完的 task 已回到 ready queue，從它的下一個開始找
+         * (sleep 後被喚醒的 task 也是 READY，但時間片沒有用完，不算在內) */
+        if ((nr_cpus > 1 || nr_workers > 0) && time_sliced() && next_task == NULL && current_task != NULL &&
+            TASK_HOT(current_task, state) == READY && TASK_HOT(current_task, time_quantum) <= 0) {
+            next_task = slice_next(current_task);
+            expired = true;
+        }
+
+        /* task 仍在執行中，繼續執行 */
+        if (next_task == NULL && current_task != NULL && TASK_HOT(current_task, state) == RUNNING) {
+            /* virtual 模式：task 在 CPU burst 中，推進 virtual clock 到下一個事件 */
+            if (virtual_mode && current_task->burst_left != 0) {
+                if (nr_cpus > 1) {
+                    virtual_cpu_next(); /* 先讓其他需要執行的 CPU 執行 */
+                } else {
+                    virtual_advance();
+                }
+                sched_unlock();
+                continue;
+            }
+            switch_end();
+            counters_switch(current_task);
+            sched_unlock();
+            context_load(&(current_task->context));
+        }
+
+        /* 從 ready queue 開頭取出下一個要執行的 task，多 CPU 時沒有則從其他 CPU 取得 */
+        if (next_task == NULL) {
+            next_task = ready_first();
+        }
+        if (next_task == NULL && nr_cpus > 1) {
+            next_task = steal(&cpus[this_cpu]);
+        }
+        if (next_task != NULL) {
+            print_running(next_task, expired && next_task == current_task);
+            dispatch(next_task);
+            switch_end();
+            counters_switch(next_task);
+            sched_unlock();
+            context_load(&(next_task->context)); /* 切換到 task context */
+        }
+
+        /* 多 CPU (單一 host thread)：這個 CPU 沒有工作，交給下一個有工作的 CPU */
+        if (nr_cpus > 1 && nr_workers == 0) {
+            if (virtual_mode && virtual_cpu_next()) {
+                sched_unlock();
+                continue;
+            }
+            int next_cpu = cpu_next_busy(this_cpu);
+            if (!virtual_mode && next_cpu >= 0) {
+                this_cpu = next_cpu;
+                sched_unlock();
+                continue;
+            }
+        }
+
+        /* 沒有 READY 也沒有 WAITING 的 task：所有 task 都已完成，結束模擬 */
+        if (waiting_queue.count == 0 && cpu_all_idle()) {
+            if (nr_workers > 0) {
+                worker_stop = WORKER_DONE; /* 其他 worker 在下一個 tick 停止，由 task_start 顯示結果 */
+                sched_unlock();
+                break;
+            }
+            sched_unlock();
+            event_drain();
+            printf("Simulation over.\n");
+            close_timer(); /* 關閉 timer */
+            if (nr_cpus > 1) {
+                cpu_report();
+            }
+            return;
+        }
+
+        /* 沒有可執行的 task，但有 task 在等待 (或其他 CPU 仍在執行)，CPU 進入 idle 狀態 */
+        is_idle = true;
+        switch_start = 0; /* 沒有下一個 task，之後從 idle 開始執行的不算 switch */
+        emit(EV_IDLE, NULL, 0, cpu_all_idle() ? 0 : EVENT_QUIET);
+        event_drain();
+        if (!virtual_mode && idle_wait()) {
+            /* 被喚醒的 task 直接 dispatch，不經過 context_load(&current_context) 回到主迴圈開頭 */
+            next_task = ready_first();
+            if (next_task != NULL) {
+                is_idle = false;
+                print_running(next_task, false);
+                dispatch(next_task);
+                counters_switch(next_task);
+                sched_unlock();
+                context_load(&(next_task->context));
+            }
+            sched_unlock();
+            continue;
+        }
+        sched_unlock();
+        if (virtual_mode) {
+            virtual_idle(); /* 直接推進到下一個喚醒的 tick */
+            continue;
+        }
+        idle(); /* 執行 idle 函數 (M:N 模式或其他 CPU 仍有工作時的無窮迴圈) */
+    }
+}
+
+/*
+ * M:N 模式的 worker thread：以 per-thread timer 執行 CPU arg 的 scheduler 主迴圈
+ */
+static void *worker_main(void *arg)
+{
+    this_cpu = (intptr_t) arg;
+    if (!virtual_mode) {
+        perf_open();
+    }
+    worker_timer_start();
+    schedule();
+    worker_timer_stop();
+    perf_close();
+    return NULL;
+}
+
+/*
+ * 開始或恢復 scheduler 執行
+ *
+ * 這是 scheduler 的主函數，負責：
+ * 1. 設定 signal handlers
+ * 2. 啟動 timer
+ * 3. 執行 scheduling 主迴圈 (M:N 模式下由 worker thread 執行，這裡等待它們停止)
+ */
+void task_start()
+{
+    switch_start = 0;
+    overhead_run_begin();
+    if (!virtual_mode && nr_workers == 0) {
+        perf_open(); /* 第一次執行時開啟，之後繼續使用 */
+    }
+    /* M:N 模式：暫停時每個 task 的 context 都已保存，worker 恢復後從各自的 CPU 繼續 */
+    if (nr_workers > 0) {
+        install_handler(SIGVTALRM, (void (*)()) worker_handler, SA_SIGINFO);
+        install_handler(SIGTSTP, worker_pause, 0);
+        worker_stop = WORKER_RUN;
+        worker_run(worker_main);
+        overhead_run_end();
+        event_drain();
+        if (worker_stop == WORKER_DONE) {
+            printf("Simulation over.\n");
+            cpu_report();
+        }
+        return;
+    }
+
+    /* 如果是從暫停狀態恢復，回到暫停時的 context */
+    if (pause) {
+        pause = false;
+        context_load(&pause_context);
+    }
+
+    /* 註冊 signal handlers */
+    install_handler(SIGVTALRM, signal_handler, 0); /* Timer signal */
+    install_handler(SIGTSTP, pause_handler, 0);    /* Ctrl+Z signal */
+
+    set_timer(); /* 啟動 timer */
+    schedule();
+    overhead_run_end();
+    event_drain(); /* 暫停時 timer 已關閉，輸出剩下的事件 */
+}
+
+/*
+ * 讓當前 task 進入 sleep 狀態
+ *
+ * 參數：ms - sleep 的時間 (單位：10ms)
+ *
+ * 執行流程：
+ * 1. 將 task 狀態設為 WAITING 並放入 waiting queue
+ * 2. 依喚醒的 tick 放入 timer wheel
+ * 3. 儲存當前 context
+ * 4. 切換回 scheduler
+ */
+void task_sleep(int ms)
+{
+    if (current_task != NULL) {
+        switch_start = overhead_stamp();
+        sched_lock();
+        clock_advance();
+        emit(EV_SLEEP, current_task, 0, 0);
+        account(current_task, jiffies);
+        burst_end(current_task);
+        TASK_HOT(current_task, state) = WAITING; /* 設為等待狀態 */
+        /* 在第 ms 個 tick 後喚醒 (至少等到下一個 tick) */
+        current_task->wake_tick = jiffies + (ms > 1 ? ms : 1);
+        list_push_back(&waiting_queue, current_task);
+        wheel_add(&sleep_wheel, current_task);
+
+        /* 儲存當前 context (當 sleep 結束後會從這裡繼續) */
+        context_save(&(current_task->context));
+
+        if (TASK_HOT(current_task, state) == WAITING) {
+            switch_to_scheduler(); /* 回到 scheduler 主迴圈 */
+        }
+    }
+}
+
+/*
+ * 讓當前 task 進入 WAITING 等待資源
+ *
+ * 由 get_resources() 在資源不足時呼叫；task 會在下一個 tick 回到 READY，
+ * 被 dispatch 時回到 get_resources() 中 context_save 的位置重新檢查資源
+ */
+void task_wait()
+{
+    if (current_task != NULL) {
+        switch_start = overhead_stamp();
+        sched_lock();
+        clock_advance();
+        account(current_task, jiffies);
+        burst_end(current_task);
+        TASK_HOT(current_task, state) = WAITING;
+        current_task->wake_tick = jiffies + 1; /* 下一個 tick 即回到 READY */
+        list_push_back(&waiting_queue, current_task);
+        wheel_add(&sleep_wheel, current_task);
+        switch_to_scheduler(); /* 回到 scheduler 主迴圈 */
+    }
+}
+
+/*
+ * Virtual 模式：讓當前 task 使用 CPU ticks 個 tick (BURST_FOREVER 表示永不結束)
+ *
+ * 只記錄剩餘的 burst 後回到 scheduler，由 scheduler 推進 virtual clock；
+ * burst 結束且 task 再次被執行時，從 context_save 的位置繼續
+ */
+void task_burst(int ticks)
+{
+    if (current_task != NULL && ticks != 0) {
+        sched_lock();
+        current_task->burst_left = ticks;
+        context_save(&(current_task->context));
+
+        if (current_task->burst_left != 0) {
+            /* 回到 scheduler 主迴圈 */
+            sched_unlock();
+            context_load(&current_context);
+        }
+    }
+}
+
+/*
+ * 有 deadline 的 task 完成一個 job：記錄 lateness、deadline miss 與 job 的 response time
+ */
+static void job_end(Task *task)
+{
+    if (task->deadline == 0) {
+        return;
+    }
+    long lateness = jiffies - task->abs_deadline;
+    long response = jiffies - task->release;
+    if (lateness > 0) {
+        task->misses++;
+    }
+    if (task->jobs == 0 || lateness > task->lateness) {
+        task->lateness = lateness;
+    }
+    if (task->jobs == 0 || response < task->job_response_min) {
+        task->job_response_min = response;
+    }
+    if (task->jobs == 0 || response > task->job_response_max) {
+        task->job_response_max = response;
+    }
+    task->jobs++;
+}
+
+/*
+ * Periodic task 完成一個 job：等到下一個 period 的 release 後從頭執行函數
+ *
+ * 下一個 job 的 release 已經過去 (這個 job 超過了 period) 時立即回到 READY，
+ * release 與絕對 deadline 仍依 period 計算，因此之後的 lateness 會反映延誤
+ */
+static void task_next_job()
+{
+    Task *task = current_task;
+    switch_start = overhead_stamp();
+    sched_lock();
+    clock_advance();
+    emit(EV_JOB, task, task->jobs + 1, 0);
+    account(task, jiffies);
+    burst_end(task);
+    job_end(task);
+    task->release += task->period;
+    task->abs_deadline = task->release + task->deadline;
+    if (task->release > jiffies) {
+        TASK_HOT(task, state) = WAITING;
+        task->wake_tick = task->release;
+        list_push_back(&waiting_queue, task);
+        wheel_add(&sleep_wheel, task);
+    } else {
+        /* job 已經結束 (EV_JOB)，下一個 job 立即 release：不是被搶佔，不記錄 EV_PREEMPT，MLFQ 也不降 level */
+        TASK_HOT(task, state) = WAITING;
+        ready_enqueue(task);
+    }
+
+    /* 儲存當前 context (release 後被 dispatch 時會從這裡繼續) */
+    context_save(&(task->context));
+
+    if (TASK_HOT(current_task, state) != RUNNING) {
+        switch_to_scheduler(); /* 回到 scheduler 主迴圈 */
+    }
+    context_load(&(current_task->job_context)); /* 回到 periodic_task 重新呼叫函數 */
+}
+
+/*
+ * 結束當前 task
+ *
+ * 結束最後一個 CPU burst 與 job 後將 task 狀態設為 TERMINATED，然後切換回 scheduler；
+ * scheduler 主迴圈切換離開它的 stack 之後以 task_reap 回收 (時間統計記錄到 archive，
+ * 釋放 hot table slot、stack 與 TCB)；
+ * periodic task 在還有 job 要執行時改為等待下一個 period (task_next_job)
+ */
+void task_exit()
+{
+    if (current_task != NULL && current_task->period > 0 &&
+        (current_task->job_limit == 0 || current_task->jobs + 1 < current_task->job_limit)) {
+        task_next_job();
+    }
+    if (current_task != NULL) {
+        switch_start = overhead_stamp();
+        sched_lock();
+        clock_advance();
+        emit(EV_EXIT, current_task, 0, 0);
+        account(current_task, jiffies);
+        burst_end(current_task);
+        job_end(current_task);
+        TASK_HOT(current_task, state) = TERMINATED; /* 標記為終止狀態，由 scheduler 主迴圈回收 */
+        switch_to_scheduler(); /* 回到 scheduler 主迴圈 */
+    }
+}
@@ -0,0 +1,194 @@
+/**
+ * @file trace.c
+ * @brief Scheduler trace 檔 (binary) 的實作檔
+ *
+ * 檔案以 mmap 對映，record 直接寫入對映的記憶體 (不經過 write system call)；
+ * 空間不足時每次把檔案加倍 (ftruncate + mremap)。
+ */
+
+#define _GNU_SOURCE
+#include "../include/trace.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+#include "../include/cpu.h"
+
+#define TRACE_INITIAL_SIZE (1 << 20) /* 初始的檔案大小 (bytes) */
+
+bool trace_enabled = false;
+
+static int trace_fd = -1;
+static char *trace_map = NULL;  /* 對映的檔案內容 */
+static size_t trace_size = 0;   /* 目前的檔案 (對映) 大小 */
+static long trace_count = 0;    /* 已寫入的 record 數 */
+static bool *named = NULL;      /* named[tid]：是否已寫入 task 名稱 */
+static int named_size = 0;
+
+static TraceRecord *trace_records()
+{
+    return (TraceRecord *) (trace_map + sizeof(TraceHeader));
+}
+
+/*
+ * 確保還能寫入 n 個 record
+ * 回傳值：成功回傳 true (失敗時停止記錄)
+ */
+static bool trace_reserve(long n)
+{
+    size_t need = sizeof(TraceHeader) + (trace_count + n) * sizeof(TraceRecord);
+    if (need <= trace_size) {
+        return true;
+    }
+    size_t size = trace_size;
+    while (size < need) {
+        size *= 2;
+    }
+    void *map = MAP_FAILED;
+    if (ftruncate(trace_fd, size) == 0) {
+        map = mremap(trace_map, trace_size, size, MREMAP_MAYMOVE);
+    }
+    if (map == MAP_FAILED) {
+        perror("trace");
+        trace_stop();
+        return false;
+    }
+    trace_map = (char *) map;
+    trace_size = size;
+    return true;
+}
+
+/*
+ * task 第一次出現時寫入名稱 record
+ */
+static void trace_name(Task *task)
+{
+    int tid = task->tid;
+    if (tid < named_size && named[tid]) {
+        return;
+    }
+    if (tid >= named_size) {
+        int size = named_size > 0 ? named_size : 64;
+        while (size <= tid) {
+            size *= 2;
+        }
+        bool *grown = (bool *) realloc(named, size * sizeof(bool));
+        if (grown == NULL) {
+            return;
+        }
+        memset(grown + named_size, 0, (size - named_size) * sizeof(bool));
+        named = grown;
+        named_size = size;
+    }
+
+    int length = strlen(task->task_name);
+    long n = (length + sizeof(TraceRecord) - 1) / sizeof(TraceRecord);
+    if (!trace_reserve(1 + n)) {
+        return;
+    }
+    TraceRecord *record = &trace_records()[trace_count];
+    memset(record, 0, (1 + n) * sizeof(TraceRecord));
+    record->tid = tid;
+    record->type = TRACE_NAME;
+    record->arg = length;
+    memcpy(record + 1, task->task_name, length);
+    trace_count += 1 + n;
+    named[tid] = true;
+}
+
+/*
+ * 開始記錄到 path (正在記錄時先停止前一個檔案)
+ * 回傳值：成功回傳 true
+ */
+bool trace_start(const char *path)
+{
+    if (trace_enabled) {
+        trace_stop();
+    }
+    trace_fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (trace_fd < 0) {
+        perror("trace");
+        return false;
+    }
+    trace_size = TRACE_INITIAL_SIZE;
+    void *map = MAP_FAILED;
+    if (ftruncate(trace_fd, trace_size) == 0) {
+        map = mmap(NULL, trace_size, PROT_READ | PROT_WRITE, MAP_SHARED, trace_fd, 0);
+    }
+    if (map == MAP_FAILED) {
+        perror("trace");
+        close(trace_fd);
+        trace_fd = -1;
+        return false;
+    }
+    trace_map = (char *) map;
+    trace_count = 0;
+    memset(named, 0, named_size * sizeof(bool));
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    TraceHeader *header = (TraceHeader *) trace_map;
+    memcpy(header->magic, TRACE_MAGIC, sizeof(header->magic));
+    header->version = TRACE_VERSION;
+    header->record = sizeof(TraceRecord);
+    header->count = 0;
+    header->start_ns = ts.tv_sec * 1000000000L + ts.tv_nsec;
+    header->nr_cpus = nr_cpus;
+    header->reserved = 0;
+    trace_enabled = true;
+    return true;
+}
+
+/*
+ * 停止記錄，把檔案截到實際使用的長度
+ */
+void trace_stop()
+{
+    if (trace_fd < 0) {
+        return;
+    }
+    trace_enabled = false;
+    trace_sync();
+    munmap(trace_map, trace_size);
+    if (ftruncate(trace_fd, sizeof(TraceHeader) + trace_count * sizeof(TraceRecord)) < 0) {
+        perror("trace");
+    }
+    close(trace_fd);
+    trace_fd = -1;
+    trace_map = NULL;
+    trace_size = 0;
+}
+
+/*
+ * 附加一個事件
+ */
+void trace_write(const Event *event)
+{
+    if (trace_enabled && event->task != NULL) {
+        trace_name(event->task); /* 失敗時會停止記錄 */
+    }
+    if (!trace_enabled || !trace_reserve(1)) {
+        return;
+    }
+    TraceRecord *record = &trace_records()[trace_count++];
+    record->tick = event->tick;
+    record->ns = event->ns;
+    record->tid = event->task != NULL ? event->task->tid : 0;
+    record->type = event->type;
+    record->cpu = event->cpu;
+    record->arg = event->arg;
+    record->flags = event->flags;
+}
+
+/*
+ * 更新 header 中的 record 數 (在此之前寫入的 record 對讀取者可見)
+ */
+void trace_sync()
+{
+    if (trace_map != NULL) {
+        ((TraceHeader *) trace_map)->count = trace_count;
+    }
+}
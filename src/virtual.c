@@ -0,0 +1,120 @@
+/**
+ * @file virtual.c
+ * @brief Discrete-event virtual-time 模式的 task script 與 burst profile
+ *
+ * 每個 script 對應 function.c 中同名函數的執行流程。
+ * task1 ~ task3 的預設 burst 為在參考機器上以真實 timer 執行時量到的 running 時間，
+ * 可用 shell 的 burst 命令調整
+ */
+
+#include "../include/virtual.h"
+#include <stdio.h>
+#include <string.h>
+#include "../include/resource.h"
+
+/* 只有 CPU 計算的函數：burst 後結束 (idle 的 burst 預設永不結束) */
+static const VirtualOp script_compute[] = {{VOP_BURST}, {VOP_EXIT}};
+
+static const VirtualOp script_test_exit[] = {{VOP_EXIT}};
+static const VirtualOp script_test_sleep[] = {{VOP_SLEEP, 20}, {VOP_EXIT}};
+static const VirtualOp script_test_resource1[] = {
+    {VOP_GET, 3, {1, 3, 7}}, {VOP_SLEEP, 5}, {VOP_RELEASE, 3, {1, 3, 7}}, {VOP_EXIT}};
+static const VirtualOp script_test_resource2[] = {{VOP_GET, 2, {0, 3}}, {VOP_RELEASE, 2, {0, 3}}, {VOP_EXIT}};
+static const VirtualOp script_task4[] = {
+    {VOP_GET, 3, {0, 1, 2}}, {VOP_SLEEP, 70}, {VOP_RELEASE, 3, {0, 1, 2}}, {VOP_EXIT}};
+static const VirtualOp script_task5[] = {{VOP_GET, 2, {1, 4}}, {VOP_SLEEP, 20}, {VOP_GET, 1, {5}},
+                                         {VOP_SLEEP, 40},      {VOP_RELEASE, 3, {1, 4, 5}}, {VOP_EXIT}};
+static const VirtualOp script_task6[] = {{VOP_GET, 2, {2, 4}}, {VOP_SLEEP, 60}, {VOP_RELEASE, 2, {2, 4}}, {VOP_EXIT}};
+static const VirtualOp script_task7[] = {
+    {VOP_GET, 3, {1, 3, 6}}, {VOP_SLEEP, 80}, {VOP_RELEASE, 3, {1, 3, 6}}, {VOP_EXIT}};
+static const VirtualOp script_task8[] = {
+    {VOP_GET, 3, {0, 4, 7}}, {VOP_SLEEP, 40}, {VOP_RELEASE, 3, {0, 4, 7}}, {VOP_EXIT}};
+static const VirtualOp script_task9[] = {{VOP_GET, 1, {5}}, {VOP_SLEEP, 80}, {VOP_GET, 2, {4, 6}},
+                                         {VOP_SLEEP, 40},   {VOP_RELEASE, 3, {4, 5, 6}}, {VOP_EXIT}};
+
+/*
+ * 所有函數的 profile (與 task_create 接受的函數名稱相同)
+ */
+static VirtualProfile profiles[] = {
+    {"task1", 50, script_compute},
+    {"task2", 85, script_compute},
+    {"task3", 27, script_compute},
+    {"task4", 0, script_task4},
+    {"task5", 0, script_task5},
+    {"task6", 0, script_task6},
+    {"task7", 0, script_task7},
+    {"task8", 0, script_task8},
+    {"task9", 0, script_task9},
+    {"test_exit", 0, script_test_exit},
+    {"test_sleep", 0, script_test_sleep},
+    {"test_resource1", 0, script_test_resource1},
+    {"test_resource2", 0, script_test_resource2},
+    {"idle", BURST_FOREVER, script_compute},
+};
+
+#define PROFILE_COUNT (sizeof(profiles) / sizeof(profiles[0]))
+
+/*
+ * 依函數名稱取得 profile
+ * 回傳值：profile 指標，找不到回傳 NULL
+ */
+VirtualProfile *virtual_lookup(char *function_name)
+{
+    for (int i = 0; i < PROFILE_COUNT; i++) {
+        if (strcmp(profiles[i].function_name, function_name) == 0) {
+            return &profiles[i];
+        }
+    }
+    return NULL;
+}
+
+/*
+ * 顯示所有函數的 burst profile (只列出有 CPU burst 的函數)
+ */
+void virtual_profile_print()
+{
+    printf("%15s|%8s\n", "function", "burst");
+    printf("------------------------\n");
+    for (int i = 0; i < PROFILE_COUNT; i++) {
+        if (profiles[i].script[0].op != VOP_BURST) {
+            continue;
+        }
+        if (profiles[i].burst == BURST_FOREVER) {
+            printf("%15s|%8s\n", profiles[i].function_name, "forever");
+        } else {
+            printf("%15s|%8d\n", profiles[i].function_name, profiles[i].burst);
+        }
+    }
+}
+
+/*
+ * Virtual 模式下所有 task 的進入點
+ *
+ * 依當前 task 的函數名稱依序執行 script；CPU 計算交給 task_burst()，
+ * 由 scheduler 推進 virtual clock，其餘操作與 function.c 中的函數呼叫相同的 API
+ */
+void virtual_task()
+{
+    Task *task = get_current_task();
+    VirtualProfile *profile = virtual_lookup(task->function_name);
+
+    for (const VirtualOp *op = profile->script;; op++) {
+        switch (op->op) {
+        case VOP_BURST:
+            task_burst(profile->burst);
+            break;
+        case VOP_SLEEP:
+            task_sleep(op->arg);
+            break;
+        case VOP_GET:
+            get_resources(op->arg, (int *) op->resources);
+            break;
+        case VOP_RELEASE:
+            release_resources(op->arg, (int *) op->resources);
+            break;
+        case VOP_EXIT:
+            task_exit();
+            while (1); /* 防護性無窮迴圈，與 function.c 相同 */
+        }
+    }
+}
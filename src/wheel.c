@@ -0,0 +1,184 @@
+/**
+ * @file wheel.c
+ * @brief Hierarchical timer wheel 的實作檔
+ *
+ * 取代原本每個 tick 把所有 WAITING task 的 sleep_time 減 10 的做法：
+ * task 進入 sleep 時依 wake_tick 放入對應 slot，每個 tick 只展開一個 slot，
+ * 只有真正到期的 task 會被碰到。
+ */
+
+#include "../include/wheel.h"
+#include <stddef.h>
+
+/*
+ * 計算第 n 層 (1 ~ 3) 中 tick 對應的 slot index
+ */
+static int level_index(long tick, int n)
+{
+    return (tick >> (WHEEL_ROOT_BITS + (n - 1) * WHEEL_LEVEL_BITS)) & (WHEEL_LEVEL_SIZE - 1);
+}
+
+/*
+ * 將 task 串到 slot list 的開頭
+ */
+static void slot_link(Task **slot, Task *task)
+{
+    task->timer_next = *slot;
+    if (*slot != NULL) {
+        (*slot)->timer_pprev = &task->timer_next;
+    }
+    *slot = task;
+    task->timer_pprev = slot;
+}
+
+/*
+ * 依 wake_tick 與 next_tick 的距離選擇 slot
+ *
+ * 距離越遠放在越高層；已過期的 task 放在下一個要處理的 slot，
+ * 超出 wheel 範圍的 task 放在最高層最遠的 slot，之後 cascade 時再重新放置
+ */
+static void wheel_place(TimerWheel *wheel, Task *task)
+{
+    long expires = task->wake_tick;
+    long delta = expires - wheel->next_tick;
+
+    if (delta < 0) {
+        slot_link(&wheel->root[wheel->next_tick & (WHEEL_ROOT_SIZE - 1)], task);
+    } else if (delta < WHEEL_ROOT_SIZE) {
+        slot_link(&wheel->root[expires & (WHEEL_ROOT_SIZE - 1)], task);
+    } else {
+        int n;
+        for (n = 1; n < WHEEL_LEVELS; n++) {
+            if (delta < 1L << (WHEEL_ROOT_BITS + n * WHEEL_LEVEL_BITS)) {
+                break;
+            }
+        }
+        if (n == WHEEL_LEVELS && delta >= 1L << (WHEEL_ROOT_BITS + n * WHEEL_LEVEL_BITS)) {
+            /* 超出範圍：先放在目前可表示的最遠位置 */
+            expires = wheel->next_tick + (1L << (WHEEL_ROOT_BITS + n * WHEEL_LEVEL_BITS)) - 1;
+        }
+        slot_link(&wheel->level[n - 1][level_index(expires, n)], task);
+    }
+}
+
+/*
+ * 將 task 依 task->wake_tick 加入 wheel
+ */
+void wheel_add(TimerWheel *wheel, Task *task)
+{
+    wheel_place(wheel, task);
+    wheel->count++;
+}
+
+/*
+ * 從 wheel 移除 task (例如 sleep 中的 task 被 del)
+ */
+void wheel_remove(TimerWheel *wheel, Task *task)
+{
+    if (task->timer_pprev == NULL) {
+        return; /* 不在 wheel 中 */
+    }
+    *task->timer_pprev = task->timer_next;
+    if (task->timer_next != NULL) {
+        task->timer_next->timer_pprev = task->timer_pprev;
+    }
+    task->timer_next = NULL;
+    task->timer_pprev = NULL;
+    wheel->count--;
+}
+
+/*
+ * 把第 n 層的一個 slot 展開到較低層
+ * 回傳值：該 slot 的 index，為 0 時表示更高一層也需要展開
+ */
+static int cascade(TimerWheel *wheel, int n)
+{
+    int index = level_index(wheel->next_tick, n);
+    Task *ptr = wheel->level[n - 1][index];
+    wheel->level[n - 1][index] = NULL;
+    while (ptr != NULL) {
+        Task *next = ptr->timer_next;
+        wheel_place(wheel, ptr);
+        ptr = next;
+    }
+    return index;
+}
+
+/*
+ * 處理所有到 tick 為止到期的 task
+ *
+ * 參數：
+ *   tick - 要處理到的 tick (含)
+ *   expire - 對每個到期 task 呼叫的函數 (task 已從 wheel 移除)
+ *
+ * 回傳值：到期的 task 數量
+ */
+int wheel_run(TimerWheel *wheel, long tick, void (*expire)(Task *))
+{
+    int woken = 0;
+    while (wheel->next_tick <= tick) {
+        int index = wheel->next_tick & (WHEEL_ROOT_SIZE - 1);
+
+        /* 每轉完一圈第 0 層，從上一層展開下一個 slot */
+        if (index == 0) {
+            int n = 1;
+            while (n <= WHEEL_LEVELS && cascade(wheel, n) == 0) {
+                n++;
+            }
+        }
+        wheel->next_tick++;
+
+        Task *ptr = wheel->root[index];
+        wheel->root[index] = NULL;
+        while (ptr != NULL) {
+            Task *next = ptr->timer_next;
+            ptr->timer_next = NULL;
+            ptr->timer_pprev = NULL;
+            wheel->count--;
+            if (ptr->wake_tick > tick) {
+                wheel_add(wheel, ptr); /* 超出範圍而被提前放置的 task，重新放置 */
+            } else {
+                expire(ptr);
+                woken++;
+            }
+            ptr = next;
+        }
+    }
+    return woken;
+}
+
+/*
+ * 取得下一個需要處理 wheel 的 tick (tickless 模式用來設定 one-shot timer)
+ *
+ * 第 0 層的 slot 直接對應到期的 tick；較高層的 task 最早也要等到下一次
+ * cascade (第 0 層轉完一圈) 才會被放到第 0 層，因此以 cascade 的 tick 為準。
+ * 這個值可能早於真正的到期時間，到時 wheel_run 只會做 cascade，不會喚醒任何 task。
+ *
+ * 回傳值：tick，wheel 為空時回傳 -1
+ */
+long wheel_next_expiry(TimerWheel *wheel)
+{
+    long next = -1;
+    int n, i;
+
+    if (wheel->count == 0) {
+        return -1;
+    }
+    for (long tick = wheel->next_tick; tick < wheel->next_tick + WHEEL_ROOT_SIZE; tick++) {
+        if (wheel->root[tick & (WHEEL_ROOT_SIZE - 1)] != NULL) {
+            next = tick;
+            break;
+        }
+    }
+
+    /* 較高層有 task 時，下一次 cascade 也是需要處理的時間點 */
+    for (n = 0; n < WHEEL_LEVELS; n++) {
+        for (i = 0; i < WHEEL_LEVEL_SIZE; i++) {
+            if (wheel->level[n][i] != NULL) {
+                long cascade_tick = (wheel->next_tick + WHEEL_ROOT_SIZE - 1) & ~((long) WHEEL_ROOT_SIZE - 1);
+                return (next >= 0 && next < cascade_tick) ? next : cascade_tick;
+            }
+        }
+    }
+    return next;
+}
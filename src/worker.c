@@ -0,0 +1,133 @@
+/**
+ * @file worker.c
+ * @brief M:N 模式的 kernel worker thread 實作檔
+ */
+
+#define _GNU_SOURCE
+#include "../include/worker.h"
+#include <pthread.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid /* glibc 2.30 之前沒有這個名稱 */
+#endif
+
+int nr_workers = 0;
+
+static __thread timer_t worker_timer; /* 目前 worker 的 per-thread timer */
+
+/* 執行檔之外可以切換 task 的 code 範圍 (registry 載入的 plugin) */
+static struct {
+    uintptr_t start;
+    uintptr_t end;
+} code_ranges[WORKER_CODE_MAX];
+static int nr_code_ranges = 0;
+
+/* 程式本身的 code 範圍 (linker 提供) */
+extern char __executable_start[];
+extern char etext[];
+
+/*
+ * 建立 nr_workers 個 thread，第 i 個執行 main((void *) i)，並等待全部結束
+ *
+ * worker 阻擋 SIGTSTP，Ctrl+Z 一定由 (在 pthread_join 中等待的) 主 thread 處理
+ */
+void worker_run(void *(*main)(void *))
+{
+    pthread_t threads[WORKER_MAX];
+    sigset_t block, old;
+
+    sigemptyset(&block);
+    sigaddset(&block, SIGTSTP);
+    pthread_sigmask(SIG_BLOCK, &block, &old);
+    for (intptr_t i = 0; i < nr_workers; i++) {
+        if (pthread_create(&threads[i], NULL, main, (void *) i) != 0) {
+            perror("worker_run");
+            exit(1);
+        }
+    }
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+
+    for (int i = 0; i < nr_workers; i++) {
+        pthread_join(threads[i], NULL);
+    }
+}
+
+/*
+ * 為目前的 worker 建立 per-thread timer：以這個 thread 的 CPU time 每 10ms 觸發一次，
+ * SIGVTALRM 只送到這個 thread (與單一 thread 時的 ITIMER_VIRTUAL 相同的計時方式)
+ */
+void worker_timer_start()
+{
+    struct sigevent event = {0};
+    struct itimerspec value;
+
+    event.sigev_notify = SIGEV_THREAD_ID;
+    event.sigev_signo = SIGVTALRM;
+    event.sigev_notify_thread_id = syscall(SYS_gettid);
+    if (timer_create(CLOCK_THREAD_CPUTIME_ID, &event, &worker_timer) != 0) {
+        perror("worker_timer_start");
+        exit(1);
+    }
+    value.it_value.tv_sec = 0;
+    value.it_value.tv_nsec = 10 * 1000 * 1000;
+    value.it_interval = value.it_value;
+    timer_settime(worker_timer, 0, &value, NULL);
+}
+
+/*
+ * 刪除目前 worker 的 timer (之後不會再有 SIGVTALRM 送到這個 thread)
+ */
+void worker_timer_stop()
+{
+    timer_delete(worker_timer);
+}
+
+/*
+ * 將 [start, end) 加入可以切換 task 的 code 範圍 (只在模擬沒有執行時呼叫)
+ */
+void worker_code_add(char *start, char *end)
+{
+    if (nr_code_ranges < WORKER_CODE_MAX) {
+        code_ranges[nr_code_ranges].start = (uintptr_t) start;
+        code_ranges[nr_code_ranges].end = (uintptr_t) end;
+        nr_code_ranges++;
+    }
+}
+
+/*
+ * 判斷 signal 打斷的位置是否可以把 task 切換走
+ *
+ * M:N 模式下被切換走的 task 可能在另一個 worker thread 上恢復。libc 內部的狀態
+ * (stdio / malloc 的 lock、暫存器中的 per-thread cache 指標) 屬於原本的 thread，
+ * 在 libc 中途換 thread 會讓其他 worker 永遠等待 lock 或破壞 malloc 的狀態。
+ * 因此只在打斷的位置位於程式本身 (或載入的 plugin) 的 code 時切換，否則留到下一個 tick 再試。
+ */
+bool worker_safe_point(void *ucontext)
+{
+    const mcontext_t *mc = &((const ucontext_t *) ucontext)->uc_mcontext;
+#if defined(__x86_64__)
+    uintptr_t ip = mc->gregs[REG_RIP];
+#elif defined(__aarch64__)
+    uintptr_t ip = mc->pc;
+#else
+    uintptr_t ip = 0; /* 無法取得，永遠視為不安全 */
+    (void) mc;
+#endif
+    if (ip >= (uintptr_t) __executable_start && ip < (uintptr_t) etext) {
+        return true;
+    }
+    for (int i = 0; i < nr_code_ranges; i++) {
+        if (ip >= code_ranges[i].start && ip < code_ranges[i].end) {
+            return true;
+        }
+    }
+    return false;
+}
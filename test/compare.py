@@ -0,0 +1,56 @@
+import sys
+from os.path import exists
+from subprocess import PIPE, run
+
+executable = "./scheduler_simulator"
+fields = ["waiting", "turnaround", "response"]
+
+
+# 去掉輸入最後的 exit，改為先執行 summary 再離開
+def read_test_case(test_case):
+    input = ""
+    with open(test_case, "r") as f:
+        for line in f.readlines():
+            if line.strip() != "exit":
+                input = input + line
+    return input + "summary\nexit\n"
+
+
+# 從輸出中取出 summary 的欄位 (每行為 "名稱 數值"，前面可能有 shell 的提示字元)
+def parse_summary(output):
+    result = {}
+    for line in output.split("\n"):
+        words = line.replace(">>> $ ", "").split()
+        if len(words) >= 2 and words[0] in fields:
+            result[words[0]] = words[1]
+    return result
+
+
+if __name__ == "__main__":
+    if not exists(executable):
+        print("The executable file is not existed. Please compile the source code first.")
+        sys.exit(0)
+
+    # 用法：python3 test/compare.py [options] {test_case} [algorithm ...]
+    # options 會傳給 scheduler_simulator (例如 --virtual)，algorithm 預設為 RR MLFQ
+    options = [arg for arg in sys.argv[1:] if arg.startswith("--")]
+    args = [arg for arg in sys.argv[1:] if not arg.startswith("--")]
+    if len(args) < 1:
+        print("Too few arguments.")
+        sys.exit(0)
+    test_case = args[0]
+    algorithms = args[1:] if len(args) > 1 else ["RR", "MLFQ"]
+    if not exists(test_case):
+        print("The test case is not existed.")
+        sys.exit(0)
+
+    input = read_test_case(test_case)
+    results = {}
+    for algo in algorithms:
+        output = run([executable] + options + [algo], stdout=PIPE, input=input, encoding="ascii").stdout
+        results[algo] = parse_summary(output)
+
+    # 各演算法的平均時間 (單位：10ms) 並排顯示
+    print("%-12s" % "" + "".join("%12s" % algo for algo in algorithms))
+    for field in fields:
+        print("%-12s" % field + "".join("%12s" % results[algo].get(field, "-") for algo in algorithms))
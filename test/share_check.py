@@ -0,0 +1,49 @@
+import random
+import signal
+import sys
+import tempfile
+import time
+from os.path import exists
+from subprocess import PIPE, Popen
+
+executable = "./scheduler_simulator"
+
+
+# 產生 count 個永不結束的 task (idle)，ticket 數 (priority) 為 1 ~ 100 的亂數
+def make_input(count):
+    random.seed(1)
+    input = ""
+    for i in range(count):
+        input = input + "add T%d idle %d\n" % (i, random.randint(1, 100))
+    return input + "start\nsummary\nexit\n"
+
+
+if __name__ == "__main__":
+    if not exists(executable):
+        print("The executable file is not existed. Please compile the source code first.")
+        sys.exit(0)
+
+    # 用法：python3 test/share_check.py {STRIDE|LOTTERY} [task 數 (預設 1000)] [執行秒數 (預設 5)]
+    # 以 virtual 模式執行，時間到時送出 SIGTSTP (Ctrl+Z) 暫停，由 summary 的 share error
+    # 檢查所有 task 都還在競爭 CPU 時，實際得到的 CPU 比例是否收斂到 ticket 比例
+    if len(sys.argv) < 2 or sys.argv[1] not in ["STRIDE", "LOTTERY"]:
+        print("Usage: python3 test/share_check.py {STRIDE|LOTTERY} [tasks] [seconds]")
+        sys.exit(0)
+    algorithm = sys.argv[1]
+    count = int(sys.argv[2]) if len(sys.argv) > 2 else 1000
+    seconds = float(sys.argv[3]) if len(sys.argv) > 3 else 5
+
+    # 每次切換都會輸出訊息，輸出量很大，先寫到暫存檔
+    with tempfile.TemporaryFile("w+", encoding="ascii") as output:
+        process = Popen([executable, "--virtual", algorithm], stdin=PIPE, stdout=output, encoding="ascii")
+        process.stdin.write(make_input(count))
+        process.stdin.flush()
+        time.sleep(seconds)
+        process.send_signal(signal.SIGTSTP)
+        process.wait()
+
+        output.seek(0)
+        for line in output:
+            words = line.replace(">>> $ ", "").split()
+            if len(words) >= 2 and words[0] in ["algorithm", "tasks", "share"]:
+                print(line.replace(">>> $ ", ""), end="")
@@ -0,0 +1,50 @@
+import sys
+from os.path import exists
+from subprocess import PIPE, run
+
+executable = "./scheduler_simulator"
+
+# 不合法的命令列參數組合：應該只顯示 Usage 就結束，不進入 shell
+invalid = [
+    ["--tickless", "--virtual", "RR"],
+    ["--virtual", "--tickless", "RR"],
+    ["--tickless", "--cpus", "2", "RR"],
+    ["--workers", "2", "--tickless", "RR"],
+    ["--workers", "2", "--virtual", "RR"],
+    ["--workers", "2", "--cpus", "2", "RR"],
+    ["--cpus", "0", "RR"],
+    ["UNKNOWN"],
+]
+
+# 合法的組合：應該進入 shell (不顯示 Usage)
+valid = [
+    ["RR"],
+    ["--tickless", "RR"],
+    ["--virtual", "RR"],
+    ["--virtual", "--cpus", "2", "RR"],
+]
+
+
+def shows_usage(options):
+    output = run([executable] + options, stdout=PIPE, input="exit\n", encoding="ascii", timeout=30).stdout
+    return output.startswith("Usage:")
+
+
+if __name__ == "__main__":
+    if not exists(executable):
+        print("The executable file is not existed. Please compile the source code first.")
+        sys.exit(0)
+
+    failed = 0
+    for options in invalid:
+        if not shows_usage(options):
+            print("accepted invalid options: %s" % " ".join(options))
+            failed += 1
+    for options in valid:
+        if shows_usage(options):
+            print("rejected valid options: %s" % " ".join(options))
+            failed += 1
+
+    if failed == 0:
+        print("The option checks work properly.")
+    sys.exit(1 if failed else 0)
@@ -0,0 +1,249 @@
+/**
+ * @file tracedump.c
+ * @brief 把 scheduler trace 檔 (trace.h) 轉成 Chrome trace-event JSON
+ *
+ * 輸出可以用 chrome://tracing 或 Perfetto (ui.perfetto.dev) 開啟：
+ * - "Tasks" process：每個 task 一條 track，dispatch 到離開 CPU (preempt / sleep / wait / exit / job 結束)
+ *   為一個執行區段
+ * - "CPUs" process：每個 CPU 一條 track，顯示在上面執行的 task
+ * - 其他事件 (wake、resource、idle ...) 為 instant event，args 中附上發生時的 tick
+ *
+ * 使用方式：make tools && ./tools/tracedump [-t] sched.trace > sched.json
+ * -t 以 tick (10ms) 而不是實際時間作為時間軸 (virtual 模式的 trace 使用)
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/trace.h"
+
+#define PID_TASKS 1
+#define PID_CPUS 2
+
+static const char *event_names[EV_TYPES] = {"dispatch", "preempt", "sleep", "wake", "wait",
+                                            "grant",    "release", "exit",  "job",  "idle"};
+
+/*
+ * 每個 task 的狀態 (以 tid 為 index)
+ */
+typedef struct DumpTask {
+    char *name;    /* TRACE_NAME record 中的名稱 */
+    bool running;  /* 是否在執行區段中 */
+    double start;  /* 執行區段的開始時間 (us) */
+    int cpu;       /* 執行所在的 CPU */
+} DumpTask;
+
+static DumpTask *tasks = NULL;
+static int nr_tasks = 0;
+static int *cpu_current = NULL; /* 每個 CPU 正在執行的 tid (0 表示沒有) */
+static int nr_cpus = 0;
+static bool first = true;       /* 是否為第一個輸出的 JSON event */
+
+static DumpTask *dump_task(int tid)
+{
+    if (tid >= nr_tasks) {
+        int size = nr_tasks > 0 ? nr_tasks : 64;
+        while (size <= tid) {
+            size *= 2;
+        }
+        tasks = (DumpTask *) realloc(tasks, size * sizeof(DumpTask));
+        if (tasks == NULL) {
+            perror("tracedump");
+            exit(1);
+        }
+        memset(tasks + nr_tasks, 0, (size - nr_tasks) * sizeof(DumpTask));
+        nr_tasks = size;
+    }
+    return &tasks[tid];
+}
+
+/*
+ * 開始一個 JSON event (處理逗號)
+ */
+static void begin_event()
+{
+    printf(first ? "\n" : ",\n");
+    first = false;
+}
+
+/*
+ * 輸出 JSON 字串 (跳脫 '"'、'\\' 與控制字元)
+ */
+static void print_string(const char *s)
+{
+    putchar('"');
+    for (; *s != '\0'; s++) {
+        if (*s == '"' || *s == '\\') {
+            printf("\\%c", *s);
+        } else if ((unsigned char) *s < 0x20) {
+            printf("\\u%04x", *s);
+        } else {
+            putchar(*s);
+        }
+    }
+    putchar('"');
+}
+
+static void print_thread_name(int pid, int tid, const char *name)
+{
+    begin_event();
+    printf("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":", pid, tid);
+    print_string(name);
+    printf("}}");
+}
+
+static const char *task_name(int tid)
+{
+    return tid < nr_tasks && tasks[tid].name != NULL ? tasks[tid].name : "?";
+}
+
+/*
+ * 結束 tid 的執行區段：在 task 與 CPU 的 track 上各輸出一個 complete event
+ */
+static void end_slice(int tid, double ts)
+{
+    DumpTask *task = dump_task(tid);
+    if (!task->running) {
+        return;
+    }
+    task->running = false;
+    begin_event();
+    printf("{\"name\":\"running\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"cpu\":%d}}",
+           PID_TASKS, tid, task->start, ts - task->start, task->cpu);
+    begin_event();
+    printf("{\"name\":");
+    print_string(task_name(tid));
+    printf(",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}", PID_CPUS, task->cpu, task->start,
+           ts - task->start);
+    if (task->cpu >= 0 && task->cpu < nr_cpus && cpu_current[task->cpu] == tid) {
+        cpu_current[task->cpu] = 0;
+    }
+}
+
+static void instant(const TraceRecord *record, double ts)
+{
+    begin_event();
+    printf("{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"args\":{\"tick\":%ld",
+           event_names[record->type], record->tid > 0 ? PID_TASKS : PID_CPUS,
+           record->tid > 0 ? record->tid : record->cpu, ts, record->tick);
+    if (record->type == EV_GRANT || record->type == EV_RELEASE) {
+        printf(",\"resource\":%d", record->arg);
+    } else if (record->type == EV_JOB) {
+        printf(",\"job\":%d", record->arg);
+    }
+    printf("}}");
+}
+
+/*
+ * 處理一個事件 record
+ */
+static void dump_record(const TraceRecord *record, double ts)
+{
+    int tid = record->tid;
+    DumpTask *task = dump_task(tid);
+    switch (record->type) {
+    case EV_DISPATCH:
+        if (task->running && task->cpu == record->cpu) {
+            return; /* 同一個 task 重新 dispatch */
+        }
+        end_slice(tid, ts);
+        if (record->cpu >= 0 && record->cpu < nr_cpus) {
+            if (cpu_current[record->cpu] != 0) {
+                end_slice(cpu_current[record->cpu], ts);
+            }
+            cpu_current[record->cpu] = tid;
+        }
+        task->running = true;
+        task->start = ts;
+        task->cpu = record->cpu;
+        return;
+    case EV_PREEMPT:
+    case EV_SLEEP:
+    case EV_WAIT:
+    case EV_EXIT:
+    case EV_JOB:
+        end_slice(tid, ts);
+        break;
+    }
+    if (record->type != EV_PREEMPT && !(record->flags & EVENT_QUIET)) {
+        instant(record, ts);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    bool ticks = false;
+    const char *path = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-t") == 0) {
+            ticks = true;
+        } else {
+            path = argv[i];
+        }
+    }
+    if (path == NULL) {
+        fprintf(stderr, "Usage: %s [-t] <trace file>\n", argv[0]);
+        return 1;
+    }
+
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        perror(path);
+        return 1;
+    }
+    TraceHeader header;
+    if (fread(&header, sizeof(header), 1, file) != 1 || memcmp(header.magic, TRACE_MAGIC, 8) != 0 ||
+        header.version != TRACE_VERSION || header.record != sizeof(TraceRecord)) {
+        fprintf(stderr, "%s: not a scheduler trace (version %d)\n", path, TRACE_VERSION);
+        return 1;
+    }
+    TraceRecord *records = (TraceRecord *) malloc((header.count > 0 ? header.count : 1) * sizeof(TraceRecord));
+    if (records == NULL || fread(records, sizeof(TraceRecord), header.count, file) != (size_t) header.count) {
+        fprintf(stderr, "%s: truncated trace\n", path);
+        return 1;
+    }
+    fclose(file);
+
+    nr_cpus = header.nr_cpus > 0 ? header.nr_cpus : 1;
+    cpu_current = (int *) calloc(nr_cpus, sizeof(int));
+
+    printf("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    begin_event();
+    printf("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"Tasks\"}}", PID_TASKS);
+    begin_event();
+    printf("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"CPUs\"}}", PID_CPUS);
+    for (int cpu = 0; cpu < nr_cpus; cpu++) {
+        char name[32];
+        snprintf(name, sizeof(name), "CPU %d", cpu);
+        print_thread_name(PID_CPUS, cpu, name);
+    }
+
+    double ts = 0;
+    for (long i = 0; i < header.count; i++) {
+        TraceRecord *record = &records[i];
+        if (record->type == TRACE_NAME) {
+            long n = (record->arg + sizeof(TraceRecord) - 1) / sizeof(TraceRecord);
+            DumpTask *task = dump_task(record->tid);
+            if (i + n >= header.count) {
+                break;
+            }
+            free(task->name);
+            task->name = strndup((const char *) (record + 1), record->arg);
+            print_thread_name(PID_TASKS, record->tid, task->name);
+            i += n;
+            continue;
+        }
+        if (record->type < 0 || record->type >= EV_TYPES) {
+            continue;
+        }
+        ts = ticks ? record->tick * 10000.0 : (record->ns - header.start_ns) / 1000.0;
+        dump_record(record, ts);
+    }
+    /* 仍在執行中的 task：區段結束在最後一個事件 */
+    for (int tid = 0; tid < nr_tasks; tid++) {
+        end_slice(tid, ts);
+    }
+    printf("\n]}\n");
+    return 0;
+}